@@ -0,0 +1,139 @@
+/**
+ * Copyright (c) 2018 Markku Linnoskivi
+ *
+ * See the file LICENSE for copying permission.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "litestorecpp/litestorecpp.hpp"
+
+namespace lscpp
+{
+/**
+ * Litestore running on an executor thread of its own.
+ *
+ * Operations are queued and run in order on the executor,
+ * results and exceptions are delivered through futures.
+ * Keys and values are copied when queued.
+ *
+ * The destructor runs the queued operations before returning.
+ */
+class AsyncLitestore
+{
+public:
+    using Task = std::function<void(Litestore& store)>;
+
+    /**
+     * Opens a handle to given Litestore instance.
+     * @param filename The Litestore filename.
+     * @param errFunc The error function, called on the executor.
+     * @throws std::runtime_error if the handle can not be opened.
+     */
+    explicit AsyncLitestore(const char* filename,
+                            Litestore::ErrorFunc errFunc = Litestore::ErrorFunc());
+    /**
+     * @param store The store, used only by the executor from now on.
+     */
+    explicit AsyncLitestore(Litestore store);
+    AsyncLitestore(const AsyncLitestore&) = delete;
+    AsyncLitestore& operator=(const AsyncLitestore&) = delete;
+    ~AsyncLitestore();
+    /**
+     * Run func with the store on the executor,
+     * e.g. to run several operations in a transaction.
+     *
+     * @return Future of the result of func.
+     */
+    template <typename Func>
+    auto submit(Func&& func)
+        -> std::future<decltype(std::declval<Func&>()(std::declval<Litestore&>()))>;
+    /**
+     * Queue task without a future.
+     * Exceptions thrown by it are ignored.
+     */
+    void post(Task task);
+
+    /** Operations, @see Litestore */
+    template <typename T>
+    std::future<void> create(const KeyView key, const T& value);
+    template <typename T>
+    std::future<T> read(const KeyView key);
+    template <typename T>
+    std::future<void> update(const KeyView key, const T& value);
+    std::future<void> del(const KeyView key);
+    std::future<void> write(WriteBatch batch);
+    std::future<std::vector<std::string>> keys(const KeyView pattern);
+
+private:
+    void run();
+
+    Litestore m_store;
+    std::mutex m_mutex;
+    std::condition_variable m_queued;
+    std::deque<Task> m_tasks;
+    bool m_stop = false;
+    // started last, after the members it uses
+    std::thread m_thread;
+};
+
+template <typename Func>
+inline
+auto AsyncLitestore::submit(Func&& func)
+    -> std::future<decltype(std::declval<Func&>()(std::declval<Litestore&>()))>
+{
+    using Result = decltype(std::declval<Func&>()(std::declval<Litestore&>()));
+    // std::function needs a copyable target
+    auto task = std::make_shared<std::packaged_task<Result(Litestore&)>>(
+        std::forward<Func>(func));
+    auto future = task->get_future();
+    post([task](Litestore& store)
+    {
+        (*task)(store);
+    });
+    return future;
+}
+
+template <typename T>
+inline
+std::future<void> AsyncLitestore::create(const KeyView key, const T& value)
+{
+    // serialized now, the value need not outlive the call
+    WriteBatch batch;
+    batch.create(key, value);
+
+    return write(std::move(batch));
+}
+
+template <typename T>
+inline
+std::future<T> AsyncLitestore::read(const KeyView key)
+{
+    return submit([key = key.str()](Litestore& store)
+    {
+        return store.read<T>(key);
+    });
+}
+
+template <typename T>
+inline
+std::future<void> AsyncLitestore::update(const KeyView key, const T& value)
+{
+    WriteBatch batch;
+    batch.update(key, value);
+
+    return write(std::move(batch));
+}
+
+}  // namespace lscpp
@@ -0,0 +1,54 @@
+/**
+ * Copyright (c) 2018 Markku Linnoskivi
+ *
+ * See the file LICENSE for copying permission.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "litestorecpp/litestorecpp.hpp"
+
+namespace lscpp
+{
+/**
+ * Bloom filter over keys.
+ *
+ * mayContain() never returns false for an added key,
+ * keys can not be removed.
+ */
+class BloomFilter
+{
+public:
+    /**
+     * Size the filter for the given number of keys.
+     *
+     * @param expectedKeys Number of keys expected to be added.
+     * @param falsePositiveRate Wanted false positive rate, in (0, 1).
+     */
+    BloomFilter(const std::size_t expectedKeys,
+                const double falsePositiveRate);
+    void add(const KeyView key) noexcept;
+    /**
+     * @return False if key was definitely not added.
+     */
+    bool mayContain(const KeyView key) const noexcept;
+    void clear() noexcept;
+    /**
+     * @return Size of the filter in bits, a power of two.
+     */
+    std::size_t bits() const noexcept { return m_numBits; }
+    /**
+     * @return Number of hash functions.
+     */
+    std::size_t hashes() const noexcept { return m_numHashes; }
+
+private:
+    std::vector<std::uint64_t> m_words;
+    std::size_t m_numBits;
+    std::size_t m_numHashes;
+};
+
+}  // namespace lscpp
@@ -0,0 +1,325 @@
+/**
+ * Copyright (c) 2018 Markku Linnoskivi
+ *
+ * See the file LICENSE for copying permission.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "litestorecpp/litestorecpp.hpp"
+
+namespace lscpp
+{
+/**
+ * LRU cache of blob values limited by a byte budget.
+ * The budget accounts for the sizes of keys and values.
+ *
+ * Not thread safe.
+ */
+class ValueCache
+{
+public:
+    /**
+     * @param budget Maximum number of bytes cached.
+     */
+    explicit ValueCache(const std::size_t budget);
+    ValueCache(const ValueCache&) = delete;
+    ValueCache& operator=(const ValueCache&) = delete;
+    /**
+     * Look up a value and mark it as recently used.
+     *
+     * @return The cached value or nullptr if not cached.
+     *         Valid until the cache is modified.
+     */
+    const std::string* get(const KeyView key);
+    /**
+     * Insert or replace a value, evicting the least
+     * recently used values to stay in budget.
+     * Values larger than the budget are not cached.
+     */
+    void put(const KeyView key, const BlobView value);
+    void erase(const KeyView key);
+    void clear() noexcept;
+    /**
+     * @return Number of cached values.
+     */
+    std::size_t size() const noexcept { return m_index.size(); }
+    /**
+     * @return Number of bytes cached.
+     */
+    std::size_t bytes() const noexcept { return m_bytes; }
+    std::size_t budget() const noexcept { return m_budget; }
+
+private:
+    struct Node
+    {
+        std::string key;
+        std::string value;
+    };
+    using Lru = std::list<Node>;
+
+    void evict(const std::size_t needed);
+
+    std::size_t m_budget;
+    std::size_t m_bytes = 0;
+    // most recently used first
+    Lru m_lru;
+    // the views point to the keys of the list nodes
+    std::unordered_map<KeyView, Lru::iterator, KeyHash> m_index;
+};
+
+/**
+ * Thread safe value cache split to independently locked shards.
+ *
+ * Keys are assigned to shards by hash, each shard is a
+ * ValueCache with an equal part of the budget.
+ */
+class ShardedValueCache
+{
+public:
+    /**
+     * Counters of a single shard.
+     */
+    struct Stats
+    {
+        std::uint64_t hits;
+        std::uint64_t misses;
+        std::size_t size;
+        std::size_t bytes;
+    };
+    /**
+     * @param budget Maximum number of bytes cached in total.
+     * @param shards Number of shards, at least one.
+     */
+    ShardedValueCache(const std::size_t budget, const std::size_t shards);
+    /**
+     * Look up a value and pass it to func while the shard is locked.
+     *
+     * @return True if the value was cached.
+     */
+    template <typename Func>
+    bool get(const KeyView key, Func&& func);
+    /**
+     * @return The generation of the shard of key,
+     *         bumped whenever a value is erased from it.
+     */
+    std::uint64_t generation(const KeyView key) const;
+    /**
+     * Insert or replace a value, unless values have been erased
+     * from the shard since generation was read.
+     * This keeps a value read before a concurrent write
+     * from getting cached after the write invalidated it.
+     */
+    void put(const KeyView key,
+             const BlobView value,
+             const std::uint64_t generation);
+    void erase(const KeyView key);
+    void clear();
+    /**
+     * @return Number of shards.
+     */
+    std::size_t shards() const noexcept { return m_shards.size(); }
+    /**
+     * @return Counters of the given shard.
+     */
+    Stats stats(const std::size_t shard) const;
+    /**
+     * @return Number of cached values in all shards.
+     */
+    std::size_t size() const;
+
+private:
+    struct Shard
+    {
+        explicit Shard(const std::size_t budget)
+            : cache(budget)
+        {}
+
+        mutable std::mutex mutex;
+        ValueCache cache;
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t generation = 0;
+    };
+
+    Shard& shardOf(const KeyView key) const;
+
+    std::vector<std::unique_ptr<Shard>> m_shards;
+};
+
+/**
+ * Read-through value cache on top of a Litestore.
+ *
+ * Values read are kept in a ShardedValueCache, except those
+ * read while a transaction is open. Writes go directly to
+ * the store and drop the written keys from the cache.
+ * Keys written in a transaction created with createTx()
+ * are dropped again when it ends.
+ *
+ * The cache can be shared by several instances, e.g. one per
+ * reader thread each owning its own handle to the same file.
+ * Writes done via store() bypass the cache, use
+ * invalidate() or clear() for such keys.
+ */
+class CachedLitestore
+{
+public:
+    using ProgressFunc = std::function<void(std::size_t done,
+                                            std::size_t total)>;
+    /**
+     * Opens a handle to given Litestore instance.
+     * @param filename The Litestore filename.
+     * @param budget Maximum number of bytes cached.
+     */
+    CachedLitestore(const char* filename, const std::size_t budget);
+    /**
+     * @param store The Litestore to cache.
+     * @param budget Maximum number of bytes cached.
+     */
+    CachedLitestore(Litestore store, const std::size_t budget);
+    /**
+     * @param store The Litestore to cache.
+     * @param cache The cache, possibly shared with other instances.
+     */
+    CachedLitestore(Litestore store, std::shared_ptr<ShardedValueCache> cache);
+    CachedLitestore(const CachedLitestore&) = delete;
+    CachedLitestore(CachedLitestore&&) = default;
+    CachedLitestore& operator=(const CachedLitestore&) = delete;
+    CachedLitestore& operator=(CachedLitestore&&) = default;
+    /**
+     * @return The underlying store.
+     */
+    Litestore& store() noexcept { return m_store; }
+    /**
+     * @return The cache.
+     */
+    const ShardedValueCache& cache() const noexcept { return *m_cache; }
+    bool is_open() const noexcept { return m_store.is_open(); }
+    void close() noexcept;
+    /**
+     * Create a transaction that drops the keys written
+     * in it from the cache when it ends.
+     */
+    Transaction createTx();
+    /**
+     * @see Litestore::create()
+     */
+    template <typename T>
+    void create(const KeyView key, const T& value);
+    /**
+     * @see Litestore::read()
+     * Served from the cache when possible.
+     */
+    template <typename T>
+    T read(const KeyView key);
+    /**
+     * @see Litestore::update()
+     */
+    template <typename T>
+    void update(const KeyView key, const T& value);
+    /**
+     * @see Litestore::del()
+     */
+    void del(const KeyView key);
+    /**
+     * Drop key from the cache.
+     */
+    void invalidate(const KeyView key);
+    /**
+     * Drop every value from the cache.
+     */
+    void clear();
+    /**
+     * Warm up the cache with the values of keys matching pattern.
+     *
+     * The values are read in parallel, each thread with its
+     * own handle to the file. In-memory stores are read with
+     * the own handle by one thread. Nothing is read while a
+     * transaction is open, its values may be uncommitted.
+     * Keys deleted meanwhile and null values are skipped.
+     * Values beyond the budget evict earlier ones.
+     *
+     * @param pattern The GLOB pattern of the keys.
+     * @param threads Number of threads, 0 for the hardware concurrency.
+     * @param progress Called with the number of keys read so far,
+     *        one call at a time.
+     * @return Number of values read.
+     * @throws std::runtime_error if not opened or operation fails.
+     *         Exceptions from progress are propagated.
+     */
+    std::size_t preload(const KeyView pattern,
+                        const std::size_t threads = 0,
+                        const ProgressFunc& progress = ProgressFunc());
+
+private:
+    using ReadFunc = int (*)(litestore_blob_t value, void* user_data);
+
+    void readImpl(const KeyView key, ReadFunc func, void* userData);
+    void written(const KeyView key);
+
+    Litestore m_store;
+    std::shared_ptr<ShardedValueCache> m_cache;
+    // keys written in the latest transaction
+    std::shared_ptr<std::vector<std::string>> m_dirty;
+};
+
+template <typename Func>
+inline
+bool ShardedValueCache::get(const KeyView key, Func&& func)
+{
+    auto& shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const auto value = shard.cache.get(key);
+    if (!value)
+    {
+        ++shard.misses;
+        return false;
+    }
+    ++shard.hits;
+    func(BlobView(value->data(), value->size()));
+
+    return true;
+}
+
+template <typename T>
+inline
+void CachedLitestore::create(const KeyView key, const T& value)
+{
+    m_store.create(key, value);
+    written(key);
+}
+
+template <typename T>
+inline
+T CachedLitestore::read(const KeyView key)
+{
+    if (std::is_same<T, std::nullptr_t>::value)
+    {
+        return m_store.read<T>(key);
+    }
+    T value;
+    BlobOutput<T> bo(value);
+    readImpl(key, &detail::readBlob<T>, &bo);
+
+    return value;
+}
+
+template <typename T>
+inline
+void CachedLitestore::update(const KeyView key, const T& value)
+{
+    m_store.update(key, value);
+    written(key);
+}
+
+}  // namespace lscpp
@@ -0,0 +1,215 @@
+/**
+ * Copyright (c) 2018 Markku Linnoskivi
+ *
+ * See the file LICENSE for copying permission.
+ */
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "litestorecpp/async_litestore.hpp"
+
+namespace lscpp
+{
+/**
+ * Awaitable operation run on the executor of an AsyncLitestore.
+ *
+ * The awaiting coroutine is resumed on the executor thread.
+ * It must not block on the results of the same executor there.
+ */
+template <typename T>
+class Operation
+{
+public:
+    using Func = std::function<T(Litestore& store)>;
+
+    Operation(AsyncLitestore& executor, Func func)
+        : m_executor(&executor),
+          m_func(std::move(func))
+    {}
+    /**
+     * An operation that is ready without running anything.
+     */
+    explicit Operation(T value)
+        : m_result(std::move(value))
+    {}
+
+    bool await_ready() const noexcept { return m_result.has_value(); }
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        m_executor->post([this, handle](Litestore& store)
+        {
+            try
+            {
+                m_result.emplace(m_func(store));
+            }
+            catch (...)
+            {
+                m_error = std::current_exception();
+            }
+            handle.resume();
+        });
+    }
+    T await_resume()
+    {
+        if (m_error)
+        {
+            std::rethrow_exception(m_error);
+        }
+        return std::move(*m_result);
+    }
+
+private:
+    AsyncLitestore* m_executor = nullptr;
+    Func m_func;
+    std::optional<T> m_result;
+    std::exception_ptr m_error;
+};
+
+template <>
+class Operation<void>
+{
+public:
+    using Func = std::function<void(Litestore& store)>;
+
+    Operation(AsyncLitestore& executor, Func func)
+        : m_executor(executor),
+          m_func(std::move(func))
+    {}
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        m_executor.post([this, handle](Litestore& store)
+        {
+            try
+            {
+                m_func(store);
+            }
+            catch (...)
+            {
+                m_error = std::current_exception();
+            }
+            handle.resume();
+        });
+    }
+    void await_resume()
+    {
+        if (m_error)
+        {
+            std::rethrow_exception(m_error);
+        }
+    }
+
+private:
+    AsyncLitestore& m_executor;
+    Func m_func;
+    std::exception_ptr m_error;
+};
+
+/**
+ * Asynchronous generator of the keys matching a pattern.
+ *
+ * The first next() takes a snapshot of the matching keys on the
+ * executor, the keys are then handed out in ascending order
+ * without further queries. Keys created or deleted after the
+ * snapshot are not reflected.
+ *
+ * @code
+ * auto keys = ls.keysAsync("user:*");
+ * while (co_await keys.next())
+ * {
+ *     use(keys.key());
+ * }
+ * @endcode
+ */
+class KeyGenerator
+{
+public:
+    KeyGenerator(AsyncLitestore& executor, std::string pattern);
+    /**
+     * Advance to the next key.
+     *
+     * @return Awaitable of false when there are no more keys.
+     */
+    Operation<bool> next();
+    /**
+     * @return The current key.
+     */
+    const std::string& key() const noexcept { return m_keys[m_pos]; }
+
+private:
+    AsyncLitestore& m_executor;
+    std::string m_pattern;
+    std::vector<std::string> m_keys;
+    std::size_t m_pos = 0;
+    bool m_started = false;
+};
+
+/**
+ * Coroutine interface to a Litestore running on an executor thread.
+ * @see AsyncLitestore
+ */
+class CoroLitestore
+{
+public:
+    /**
+     * Opens a handle to given Litestore instance.
+     * @param filename The Litestore filename.
+     * @throws std::runtime_error if the handle can not be opened.
+     */
+    explicit CoroLitestore(const char* filename)
+        : m_executor(filename)
+    {}
+    explicit CoroLitestore(Litestore store)
+        : m_executor(std::move(store))
+    {}
+    /**
+     * @return The executor, e.g. for future based access.
+     */
+    AsyncLitestore& executor() noexcept { return m_executor; }
+
+    /** Operations, @see Litestore */
+    template <typename T>
+    Operation<void> createAsync(const KeyView key, const T& value)
+    {
+        WriteBatch batch;
+        batch.create(key, value);
+
+        return writeAsync(std::move(batch));
+    }
+    template <typename T>
+    Operation<T> readAsync(const KeyView key)
+    {
+        return Operation<T>(m_executor, [key = key.str()](Litestore& store)
+        {
+            return store.read<T>(key);
+        });
+    }
+    template <typename T>
+    Operation<void> updateAsync(const KeyView key, const T& value)
+    {
+        WriteBatch batch;
+        batch.update(key, value);
+
+        return writeAsync(std::move(batch));
+    }
+    Operation<void> delAsync(const KeyView key);
+    Operation<void> writeAsync(WriteBatch batch);
+    /**
+     * @param pattern The GLOB pattern of the keys.
+     */
+    KeyGenerator keysAsync(const KeyView pattern);
+
+private:
+    AsyncLitestore m_executor;
+};
+
+}  // namespace lscpp
@@ -0,0 +1,116 @@
+/**
+ * Copyright (c) 2018 Markku Linnoskivi
+ *
+ * See the file LICENSE for copying permission.
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "litestorecpp/litestorecpp.hpp"
+
+namespace lscpp
+{
+/**
+ * Write front end committing the writes of many threads together.
+ *
+ * Producers push writes to a lock-free queue. A writer thread
+ * drains the queue and commits the writes in one transaction
+ * per batch, so concurrent writes share a single sync to disk.
+ * A future is made ready once its write has been committed.
+ *
+ * If a batch fails, each of its writes is retried in a
+ * transaction of its own, so a failing write only fails its
+ * own future.
+ *
+ * The destructor commits the writes queued before it was called.
+ */
+class GroupCommitWriter
+{
+public:
+    /**
+     * Opens a handle to given Litestore instance.
+     * @param filename The Litestore filename.
+     * @param maxBatch Maximum number of writes per transaction.
+     * @throws std::runtime_error if the handle can not be opened.
+     */
+    explicit GroupCommitWriter(const char* filename,
+                               const std::size_t maxBatch = 1024);
+    /**
+     * @param store The store, used only by the writer thread from now on.
+     * @param maxBatch Maximum number of writes per transaction.
+     */
+    explicit GroupCommitWriter(Litestore store,
+                               const std::size_t maxBatch = 1024);
+    GroupCommitWriter(const GroupCommitWriter&) = delete;
+    GroupCommitWriter& operator=(const GroupCommitWriter&) = delete;
+    ~GroupCommitWriter();
+
+    /** Writes, @see Litestore */
+    template <typename T>
+    std::future<void> create(const KeyView key, const T& value);
+    template <typename T>
+    std::future<void> update(const KeyView key, const T& value);
+    std::future<void> del(const KeyView key);
+    /**
+     * Queue a batch that is applied atomically.
+     */
+    std::future<void> write(WriteBatch batch);
+    /**
+     * @return Number of transactions committed.
+     */
+    std::uint64_t commits() const noexcept { return m_commits; }
+
+private:
+    struct Node
+    {
+        WriteBatch batch;
+        std::promise<void> done;
+        Node* next;
+    };
+
+    std::future<void> push(Node* node);
+    void run();
+    void commit(Node* first, Node* last);
+
+    Litestore m_store;
+    const std::size_t m_maxBatch;
+    // pushed nodes, most recent first
+    std::atomic<Node*> m_head;
+    std::atomic<bool> m_sleeping;
+    std::atomic<bool> m_stop;
+    std::atomic<std::uint64_t> m_commits;
+    // only used when the writer has nothing to do
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    // started last, after the members it uses
+    std::thread m_thread;
+};
+
+template <typename T>
+inline
+std::future<void> GroupCommitWriter::create(const KeyView key, const T& value)
+{
+    WriteBatch batch;
+    batch.create(key, value);
+
+    return write(std::move(batch));
+}
+
+template <typename T>
+inline
+std::future<void> GroupCommitWriter::update(const KeyView key, const T& value)
+{
+    WriteBatch batch;
+    batch.update(key, value);
+
+    return write(std::move(batch));
+}
+
+}  // namespace lscpp
@@ -0,0 +1,85 @@
+/**
+ * Copyright (c) 2018 Markku Linnoskivi
+ *
+ * See the file LICENSE for copying permission.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "litestorecpp/litestorecpp.hpp"
+
+namespace lscpp
+{
+/**
+ * Tracks the most frequently accessed keys.
+ *
+ * Accesses are counted in a count-min sketch and the keys
+ * with the highest estimates are kept as a bounded set of
+ * candidates. Counts never underestimate, but colliding keys
+ * may inflate them.
+ *
+ * Not thread safe.
+ */
+class HotKeyTracker
+{
+public:
+    /**
+     * @param sampleEvery Record every n:th access, at least 1.
+     * @param capacity Number of candidates kept.
+     * @param width Counters per sketch row.
+     * @param depth Number of sketch rows.
+     */
+    explicit HotKeyTracker(const std::size_t sampleEvery = 1,
+                           const std::size_t capacity = 64,
+                           const std::size_t width = 1024,
+                           const std::size_t depth = 4);
+    HotKeyTracker(const HotKeyTracker&) = delete;
+    HotKeyTracker& operator=(const HotKeyTracker&) = delete;
+    /**
+     * Record an access of key, subject to sampling.
+     */
+    void record(const KeyView key);
+    /**
+     * @return Estimated number of accesses of key.
+     */
+    std::uint64_t estimate(const KeyView key) const noexcept;
+    /**
+     * @return Up to k candidates in descending order of count.
+     */
+    std::vector<HotKey> top(const std::size_t k) const;
+    void clear() noexcept;
+
+private:
+    struct Candidate
+    {
+        std::string key;
+        std::uint64_t count;
+        // position in m_heap
+        std::size_t heapPos;
+    };
+
+    std::uint64_t add(const KeyView key) noexcept;
+    bool less(const std::size_t a, const std::size_t b) const noexcept;
+    void place(const std::size_t pos, const std::size_t slot) noexcept;
+    void siftUp(std::size_t pos) noexcept;
+    void siftDown(std::size_t pos) noexcept;
+
+    std::size_t m_sampleEvery;
+    std::size_t m_capacity;
+    std::size_t m_width;
+    std::size_t m_depth;
+    std::uint64_t m_accesses = 0;
+    std::vector<std::uint64_t> m_counters;
+    // never reallocated, the index views point to the keys
+    std::vector<Candidate> m_slots;
+    // slots as a min-heap by count
+    std::vector<std::size_t> m_heap;
+    std::unordered_map<KeyView, std::size_t, KeyHash> m_index;
+};
+
+}  // namespace lscpp
@@ -0,0 +1,128 @@
+/**
+ * Copyright (c) 2018 Markku Linnoskivi
+ *
+ * See the file LICENSE for copying permission.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "litestorecpp/litestorecpp.hpp"
+
+namespace lscpp
+{
+/**
+ * Thread safe pool of Litestore handles to the same file.
+ *
+ * Handles are leased to one thread at a time and returned
+ * to the pool when the lease is destroyed. The pool opens
+ * handles on demand up to its maximum size and shrink()
+ * closes idle handles above its minimum size.
+ *
+ * Every handle to ":memory:" is a database of its own,
+ * so pooling is only meaningful for files.
+ * The pool must outlive its leases.
+ */
+class LitestorePool
+{
+public:
+    /**
+     * Exclusive use of a pooled handle.
+     * A default constructed or moved from lease is empty.
+     * Transactions created with the handle must end before
+     * it is returned.
+     */
+    class Lease
+    {
+    public:
+        Lease() = default;
+        Lease(const Lease&) = delete;
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&& other) noexcept;
+        ~Lease();
+        /**
+         * @return True if the lease holds a handle.
+         */
+        explicit operator bool() const noexcept { return m_pool != nullptr; }
+        Litestore& operator*() noexcept { return m_store; }
+        Litestore* operator->() noexcept { return &m_store; }
+        /**
+         * Return the handle to the pool early.
+         */
+        void release() noexcept;
+
+    private:
+        friend class LitestorePool;
+
+        Lease(LitestorePool* pool, Litestore store) noexcept;
+
+        LitestorePool* m_pool = nullptr;
+        Litestore m_store;
+    };
+
+    /**
+     * Opens minSize handles to filename.
+     *
+     * @param filename The Litestore filename.
+     * @param minSize Number of handles kept open.
+     * @param maxSize Maximum number of handles, at least minSize and 1.
+     * @param errFunc The error function given to every handle.
+     * @throws std::runtime_error if a handle can not be opened.
+     */
+    LitestorePool(std::string filename,
+                  const std::size_t minSize,
+                  const std::size_t maxSize,
+                  Litestore::ErrorFunc errFunc = Litestore::ErrorFunc());
+    LitestorePool(const LitestorePool&) = delete;
+    LitestorePool& operator=(const LitestorePool&) = delete;
+    /**
+     * Lease a handle, opening a new one if none is idle and the
+     * pool is not at its maximum. Otherwise blocks until one
+     * is returned.
+     *
+     * @throws std::runtime_error if a handle can not be opened.
+     */
+    Lease acquire();
+    /**
+     * Like acquire(), but returns an empty lease instead of blocking.
+     */
+    Lease tryAcquire();
+    /**
+     * Close idle handles above the minimum size.
+     *
+     * @return Number of handles closed.
+     */
+    std::size_t shrink();
+    /**
+     * @return Number of open handles, leased or idle.
+     */
+    std::size_t size() const;
+    /**
+     * @return Number of idle handles.
+     */
+    std::size_t idle() const;
+    std::size_t minSize() const noexcept { return m_minSize; }
+    std::size_t maxSize() const noexcept { return m_maxSize; }
+
+private:
+    Lease lease(std::unique_lock<std::mutex>& lock);
+    Litestore open();
+    void release(Litestore store) noexcept;
+
+    const std::string m_filename;
+    const std::size_t m_minSize;
+    const std::size_t m_maxSize;
+    const Litestore::ErrorFunc m_errFunc;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_returned;
+    std::vector<Litestore> m_idle;
+    // leased, idle and being opened
+    std::size_t m_size = 0;
+};
+
+}  // namespace lscpp
@@ -5,16 +5,24 @@
  */
 #pragma once
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <memory>
 #include <string>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 #include "litestore/litestore.h"
 
 namespace lscpp
 {
+class BloomFilter;
+class HotKeyTracker;
+
 namespace detail
 {
 /**
@@ -25,7 +33,170 @@ struct LSDelete
     void operator()(litestore*) const;
 };
 using Handle = std::unique_ptr<::litestore, LSDelete>;
+/**
+ * State shared between a Litestore and its Transactions.
+ * Heap allocated so that it stays put when Litestore is moved.
+ */
+struct Context
+{
+    ~Context();
+
+    std::function<void(const int error, const char* desc)> errorFunc;
+    // the file the handle was opened to
+    std::string filename;
+    bool inTx = false;
+    // set when a callback stops an iteration on purpose
+    bool muteErrors = false;
+    // optional filter of existing keys
+    std::unique_ptr<BloomFilter> keyFilter;
+    // optional access sampling
+    std::unique_ptr<HotKeyTracker> hotKeys;
+    // bumped whenever the set of keys may have changed
+    std::uint64_t generation = 0;
+    // optional memoized keys() results by pattern, 0 when disabled
+    struct KeysEntry
+    {
+        std::uint64_t generation;
+        std::shared_ptr<const std::vector<std::string>> keys;
+    };
+    std::size_t keysCacheCapacity = 0;
+    std::unordered_map<std::string, KeysEntry> keysCache;
+};
+
+/**
+ * @return True if every handle opened to filename
+ *         gets a database of its own.
+ */
+bool isPrivateDatabase(const std::string& filename);
+/**
+ * Function run by each thread of runWorkers(), receiving the
+ * index of the thread and a flag raised when another one failed.
+ */
+using WorkerFunc = std::function<void(const std::size_t i,
+                                      const std::atomic<bool>& stop)>;
+/**
+ * Run work on n threads and wait for them to finish.
+ * A single worker runs on the calling thread.
+ *
+ * @throws The first exception thrown by work, after raising
+ *         stop and joining the other threads.
+ */
+void runWorkers(const std::size_t n, const WorkerFunc& work);
+}
+
+/**
+ * Non-owning view to the bytes of a stored blob.
+ *
+ * A view handed out by Litestore is only valid for the
+ * duration of the callback it is passed to.
+ */
+class BlobView
+{
+public:
+    BlobView() = default;
+    BlobView(const void* data, const std::size_t size) noexcept
+        : m_data(data),
+          m_size(size)
+    {}
+    const void* data() const noexcept { return m_data; }
+    std::size_t size() const noexcept { return m_size; }
+    bool empty() const noexcept { return m_size == 0; }
+
+private:
+    const void* m_data = nullptr;
+    std::size_t m_size = 0;
+};
+
+/**
+ * Non-owning view to a key.
+ *
+ * Implicitly constructible from string literals and std::string,
+ * so keys can be passed without building a temporary std::string.
+ * A view handed out by Litestore is only valid for the
+ * duration of the callback it is passed to.
+ */
+class KeyView
+{
+public:
+    KeyView() = default;
+    KeyView(const char* data, const std::size_t size) noexcept
+        : m_data(data),
+          m_size(size)
+    {}
+    KeyView(const char* str) noexcept
+        : m_data(str),
+          m_size(std::strlen(str))
+    {}
+    KeyView(const std::string& str) noexcept
+        : m_data(str.data()),
+          m_size(str.size())
+    {}
+    const char* data() const noexcept { return m_data; }
+    std::size_t size() const noexcept { return m_size; }
+    bool empty() const noexcept { return m_size == 0; }
+    std::string str() const { return std::string(m_data, m_size); }
+    const char* begin() const noexcept { return m_data; }
+    const char* end() const noexcept { return m_data + m_size; }
+
+    friend bool operator==(const KeyView& lhs, const KeyView& rhs) noexcept
+    {
+        return lhs.m_size == rhs.m_size
+            && (lhs.m_size == 0
+                || std::memcmp(lhs.m_data, rhs.m_data, lhs.m_size) == 0);
+    }
+    friend bool operator!=(const KeyView& lhs, const KeyView& rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+private:
+    const char* m_data = nullptr;
+    std::size_t m_size = 0;
+};
+
+/**
+ * FNV-1a hash of a key, usable with unordered containers.
+ */
+struct KeyHash
+{
+    std::size_t operator()(const KeyView key) const noexcept
+    {
+        std::uint64_t h = 14695981039346656037ull;
+        for (const char c : key)
+        {
+            h ^= static_cast<unsigned char>(c);
+            h *= 1099511628211ull;
+        }
+        return static_cast<std::size_t>(h);
+    }
+};
+
+namespace detail
+{
+/**
+ * MurmurHash3 finalizer, derives a second independent
+ * hash from a KeyHash value for double hashing.
+ */
+inline
+std::uint64_t mixHash(std::uint64_t h) noexcept
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
 }
+}
+
+/**
+ * A key and its estimated access count, see Litestore::hotKeys().
+ */
+struct HotKey
+{
+    std::string key;
+    std::uint64_t count;
+};
 
 /**
  * RAII class for transactions.
@@ -40,6 +211,7 @@ class Transaction
     friend class Litestore;
 public:
     enum class State { INITIAL, OPEN, DONE };
+    using Hook = std::function<void()>;
     /**
      * Destructor will rollback the transaction if it's not done.
      */
@@ -62,12 +234,192 @@ public:
      * @throws std::runtime_error On failure.
      */
     void rollback();
+    /**
+     * Add a function that is called after the transaction
+     * is rolled back, also when done by the destructor.
+     * Exceptions thrown by the hook are ignored.
+     */
+    void onRollback(Hook hook);
+    /**
+     * Add a function that is called after the transaction
+     * is committed. Exceptions thrown by the hook are ignored.
+     */
+    void onCommit(Hook hook);
+    /**
+     * Add a function that is called right before the transaction
+     * is committed, e.g. to flush buffered writes. Exceptions
+     * thrown by the hook propagate and nothing is committed.
+     */
+    void beforeCommit(Hook hook);
 
 private:
-    Transaction(litestore* ls);
+    Transaction(litestore* ls, detail::Context* ctx);
+    void rolledBack() noexcept;
+    void committed() noexcept;
 
     litestore* m_litestore = nullptr;
+    detail::Context* m_context = nullptr;
     State m_state = State::INITIAL;
+    std::vector<Hook> m_rollbackHooks;
+    std::vector<Hook> m_commitHooks;
+    std::vector<Hook> m_beforeCommitHooks;
+};
+
+/**
+ * Result of Litestore::readMany.
+ *
+ * All values are stored to one contiguous buffer that is
+ * reused when the instance is passed to readMany again.
+ * Views are valid until the next readMany or clear().
+ */
+class MultiRead
+{
+    friend class Litestore;
+public:
+    /**
+     * @return Number of keys read.
+     */
+    std::size_t size() const noexcept { return m_entries.size(); }
+    /**
+     * @return True if the i:th key was found.
+     */
+    bool found(const std::size_t i) const { return m_entries[i].found; }
+    /**
+     * @return True if the i:th key was found and has a null value.
+     */
+    bool null(const std::size_t i) const { return m_entries[i].null; }
+    /**
+     * @return View to the value of the i:th key,
+     *         empty if the key was not found or is null.
+     */
+    BlobView operator[](const std::size_t i) const
+    {
+        const auto& e = m_entries[i];
+        return BlobView(m_arena.data() + e.offset, e.size);
+    }
+    void clear() noexcept
+    {
+        m_arena.clear();
+        m_entries.clear();
+    }
+
+private:
+    struct Entry
+    {
+        std::size_t offset;
+        std::size_t size;
+        bool found;
+        bool null;
+    };
+
+    std::vector<char> m_arena;
+    std::vector<Entry> m_entries;
+};
+
+/**
+ * Buffer for key listings, see Litestore::keys().
+ *
+ * All keys are stored to one contiguous buffer that is
+ * reused when the arena is passed to keys() again.
+ * Views are valid until the next keys() or clear().
+ */
+class KeyArena
+{
+public:
+    /**
+     * @return Number of keys.
+     */
+    std::size_t size() const noexcept { return m_entries.size(); }
+    bool empty() const noexcept { return m_entries.empty(); }
+    /**
+     * @return View to the i:th key.
+     */
+    KeyView operator[](const std::size_t i) const
+    {
+        const auto& e = m_entries[i];
+        return KeyView(m_arena.data() + e.offset, e.size);
+    }
+    /**
+     * Append a copy of key.
+     */
+    void add(const KeyView key)
+    {
+        m_entries.push_back({m_arena.size(), key.size()});
+        m_arena.insert(m_arena.end(), key.data(), key.data() + key.size());
+    }
+    void clear() noexcept
+    {
+        m_arena.clear();
+        m_entries.clear();
+    }
+
+private:
+    struct Entry
+    {
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    std::vector<char> m_arena;
+    std::vector<Entry> m_entries;
+};
+
+/**
+ * A set of create, update and delete operations that
+ * are applied at once with Litestore::write().
+ *
+ * Keys and values are copied to an internal buffer,
+ * so the arguments need not outlive the batch.
+ */
+class WriteBatch
+{
+    friend class Litestore;
+public:
+    /**
+     * Add a create operation.
+     * The template type T must have valid specialization for
+     * BlobInput class.
+     */
+    template <typename T>
+    void create(const KeyView key, const T& value);
+    /**
+     * Add an update operation.
+     * The template type T must have valid specialization for
+     * BlobInput class.
+     */
+    template <typename T>
+    void update(const KeyView key, const T& value);
+    /**
+     * Add a delete operation.
+     */
+    void del(const KeyView key);
+    /**
+     * @return Number of operations in the batch.
+     */
+    std::size_t size() const noexcept { return m_entries.size(); }
+    bool empty() const noexcept { return m_entries.empty(); }
+    void clear() noexcept
+    {
+        m_arena.clear();
+        m_entries.clear();
+    }
+
+private:
+    enum class Op { CREATE, UPDATE, DEL };
+    struct Entry
+    {
+        Op op;
+        std::size_t keyOffset;
+        std::size_t keyLength;
+        std::size_t valueOffset;
+        std::size_t valueSize;
+        bool null;
+    };
+
+    void add(const Op op, const KeyView key, litestore_blob_t value);
+
+    std::vector<char> m_arena;
+    std::vector<Entry> m_entries;
 };
 
 /**
@@ -80,6 +432,11 @@ class Litestore
 {
 public:
     using ErrorFunc = std::function<void(const int error, const char* desc)>;
+    using ViewFunc = std::function<void(BlobView value)>;
+    using KeyFunc = std::function<bool(KeyView key)>;
+    using EntryFunc = std::function<bool(KeyView key, BlobView value)>;
+    using ParallelEntryFunc = std::function<void(KeyView key, BlobView value)>;
+    using SharedKeys = std::shared_ptr<const std::vector<std::string>>;
     /**
      * Default constucted instance has no open handles to Litestore.
      */
@@ -107,6 +464,69 @@ public:
      *         the Litestore.
      */
     bool is_open() const noexcept;
+    /**
+     * @return The filename the instance was opened with,
+     *         empty if never opened.
+     */
+    std::string filename() const;
+    /**
+     * @return True if a transaction created by this
+     *         instance is open.
+     */
+    bool inTx() const noexcept;
+    /**
+     * Build a Bloom filter over the current keys.
+     * Reads, readMany() and exists() use it to reject
+     * absent keys without querying the store.
+     * Keys written via this instance are added to the filter.
+     *
+     * @note Only valid while this instance is the only writer
+     *       of the store, deleted keys stay in the filter.
+     * @param expectedKeys Number of keys the filter is sized for,
+     *        at least the current number of keys is used.
+     * @param falsePositiveRate Wanted false positive rate.
+     * @throws std::runtime_error if operation fails.
+     */
+    void enableKeyFilter(const std::size_t expectedKeys,
+                         const double falsePositiveRate = 0.01);
+    void disableKeyFilter() noexcept;
+    /**
+     * Memoize the results of keys(pattern), sharedKeys(pattern)
+     * and count(pattern) for up to maxPatterns patterns.
+     * sharedKeys() returns the memoized list without copying
+     * it, keys() returns a copy. The results are reused
+     * until a write or a rollback via this instance may have
+     * changed the set of keys.
+     *
+     * @note Only valid while this instance is the only writer
+     *       of the store.
+     * @param maxPatterns Number of patterns memoized.
+     * @throws std::runtime_error if not opened.
+     */
+    void enableKeysCache(const std::size_t maxPatterns);
+    void disableKeysCache() noexcept;
+    /**
+     * Sample the keys of reads, updates and deletes to a
+     * count-min sketch and keep track of the most accessed ones.
+     * Memory use is bounded, counts are estimates.
+     *
+     * @param sampleEvery Record every n:th access, at least 1.
+     * @param capacity Number of hot key candidates tracked.
+     * @throws std::runtime_error if not opened.
+     */
+    void enableHotKeyTracking(const std::size_t sampleEvery = 1,
+                              const std::size_t capacity = 64);
+    void disableHotKeyTracking() noexcept;
+    /**
+     * @return Up to k most accessed keys in descending order
+     *         of count, empty if tracking is not enabled.
+     */
+    std::vector<HotKey> hotKeys(const std::size_t k) const;
+    /**
+     * Count an access of key served without this handle,
+     * for example from a cache in front of it.
+     */
+    void recordAccess(const KeyView key);
     /**
      * Explicitely close the handle to Litestore.
      */
@@ -126,18 +546,70 @@ public:
      * @throws std::runtime_error if Operation fails or key exists.
      */
     template <typename T>
-    void create(const std::string& key, const T& value);
+    void create(const KeyView key, const T& value);
     /**
      * Read a blob of type T with key.
      * The template type T must have valid specialization for 
      * BlobOutput class.
+     * Fails if the stored blob does not fit the type
+     * e.g. the size differs for POD types.
      * 
      * @param key The key.
      * @return The blob T.
      * @throws std::runtime_error if operation fails or key does not exist.
      */
     template <typename T>
-    T read(const std::string& key);
+    T read(const KeyView key);
+    /**
+     * Read a blob with key without copying it.
+     * The function is called with a view to the stored bytes,
+     * the view is valid only until the function returns.
+     * Exceptions thrown by the function are propagated.
+     *
+     * @param key The key.
+     * @param func The function receiving the view.
+     * @throws std::runtime_error if operation fails or key does not exist.
+     */
+    void readView(const KeyView key, const ViewFunc& func);
+    /**
+     * Like readView(), but a missing key or a null value is
+     * not an error. The function is not called for those.
+     *
+     * @param key The key.
+     * @param func The function receiving the view.
+     * @return True if func was called.
+     * @throws std::runtime_error if operation fails.
+     */
+    bool tryReadView(const KeyView key, const ViewFunc& func);
+    /**
+     * Read a blob with key into a caller owned buffer.
+     * If the blob does not fit, nothing is copied and the
+     * returned size tells the required capacity.
+     *
+     * @param key The key.
+     * @param buffer The destination buffer.
+     * @param capacity The size of the buffer in bytes.
+     * @return The size of the blob in bytes.
+     * @throws std::runtime_error if operation fails or key does not exist.
+     */
+    std::size_t readInto(const KeyView key,
+                         void* buffer,
+                         const std::size_t capacity);
+    /**
+     * Read the blobs of several keys at once.
+     * The reads are done in a single transaction,
+     * unless one is already open.
+     *
+     * @param keys The keys.
+     * @return The values in the order of keys.
+     * @throws std::runtime_error if operation fails.
+     *         Missing keys and null values are not an error.
+     */
+    MultiRead readMany(const std::vector<KeyView>& keys);
+    /**
+     * As above, but reuses the buffers of result.
+     */
+    void readMany(const std::vector<KeyView>& keys, MultiRead& result);
     /**
      * Update existing value to a blob.
      * If key does not exist, it is created.
@@ -149,27 +621,145 @@ public:
      * @throws std::runtime_error if operation fails.
      */
     template <typename T>
-    void update(const std::string& key, const T& value);
+    void update(const KeyView key, const T& value);
     /**
      * Delete the given key.
      *
      * @param key The key.
      * @throws std::runtime_error if operation fails.
      */
-    void del(const std::string& key);
+    void del(const KeyView key);
+    /**
+     * Check if key exists without reading its value.
+     *
+     * @param key The key.
+     * @return True if key exists.
+     * @throws std::runtime_error if operation fails.
+     */
+    bool exists(const KeyView key);
+    /**
+     * Apply all operations of the batch in order.
+     * The operations are done in a single transaction,
+     * unless one is already open.
+     *
+     * @param batch The operations.
+     * @throws std::runtime_error if any operation fails.
+     */
+    void write(const WriteBatch& batch);
     /**
      * Get a list of keys matching the given pattern.
+     * Served from memory when enableKeysCache() is used.
+     * The order of the keys is unspecified, see scanPrefix()
+     * and scanRange() for sorted results.
      *
      * @return Vector of keys matched to pattern.
      */
-    std::vector<std::string> keys(const std::string& pattern);
+    std::vector<std::string> keys(const KeyView pattern);
+    /**
+     * As above, but the list is shared instead of copied.
+     * With enableKeysCache() repeated calls return the same
+     * list without querying the store, until a write.
+     *
+     * @return Keys matched to pattern.
+     */
+    SharedKeys sharedKeys(const KeyView pattern);
+    /**
+     * Stream the keys matching the given pattern to func
+     * without collecting them. Iteration stops when func
+     * returns false. Exceptions thrown by func are propagated.
+     *
+     * @param pattern The pattern.
+     * @param func The function receiving the keys.
+     * @throws std::runtime_error if operation fails.
+     */
+    void keys(const KeyView pattern, const KeyFunc& func);
+    /**
+     * Get the keys matching the given pattern into an arena.
+     * Any previous contents of the arena are discarded.
+     *
+     * @param pattern The pattern.
+     * @param arena The arena receiving the keys.
+     * @throws std::runtime_error if operation fails.
+     */
+    void keys(const KeyView pattern, KeyArena& arena);
+    /**
+     * Count the keys matching the given pattern
+     * without collecting them.
+     *
+     * @param pattern The pattern.
+     * @return Number of matching keys.
+     * @throws std::runtime_error if operation fails.
+     */
+    std::size_t count(const KeyView pattern);
+    /**
+     * Visit the keys matching the given pattern together with
+     * their values in a single pass. Null values are passed
+     * as empty views. Iteration stops when func returns false.
+     * Exceptions thrown by func are propagated.
+     * The reads are done in a single transaction,
+     * unless one is already open.
+     *
+     * @param pattern The pattern.
+     * @param func The function receiving the keys and values.
+     * @throws std::runtime_error if operation fails.
+     */
+    void forEach(const KeyView pattern, const EntryFunc& func);
+    /**
+     * Visit the keys matching the given pattern together with
+     * their values using several threads.
+     *
+     * The key space is split to ranges by key prefix, ranges with
+     * many keys are split further by the next byte while visiting.
+     * Each thread lists and reads its ranges with a handle of its
+     * own, threads that run out of ranges steal from the others.
+     * In-memory stores and stores in a transaction are read with
+     * the own handle by the calling thread.
+     *
+     * Keys deleted meanwhile and null values are skipped.
+     * Func is called concurrently, the first exception thrown by it
+     * stops the visit and is propagated.
+     *
+     * @param pattern The pattern.
+     * @param func The function receiving the keys and values.
+     * @param threads Number of threads, 0 for the hardware concurrency.
+     * @throws std::runtime_error if operation fails.
+     */
+    void parallelForEach(const KeyView pattern,
+                         const ParallelEntryFunc& func,
+                         const std::size_t threads = 0);
+    /**
+     * Get the keys starting with prefix.
+     * The prefix is matched literally, not as a pattern.
+     *
+     * @param prefix The prefix.
+     * @return The keys in ascending byte order.
+     * @throws std::runtime_error if operation fails.
+     */
+    std::vector<std::string> scanPrefix(const KeyView prefix);
+    /**
+     * Get the keys in range [begin, end).
+     *
+     * @param begin The first key of the range.
+     * @param end One past the last key, empty for no upper bound.
+     * @param limit Maximum number of keys returned, 0 for no limit.
+     * @return The smallest keys in range in ascending byte order.
+     * @throws std::runtime_error if operation fails.
+     */
+    std::vector<std::string> scanRange(const KeyView begin,
+                                       const KeyView end,
+                                       const std::size_t limit = 0);
 
 private:
-    void createImpl(const std::string& key, litestore_blob_t blobIn);
-    void readImpl(const std::string& key, void* blobOut);
-    void updateImpl(const std::string& key, litestore_blob_t blobIn);
+    void createImpl(const KeyView key, litestore_blob_t blobIn);
+    using ReadFunc = int (*)(litestore_blob_t value, void* user_data);
+
+    void readImpl(const KeyView key, ReadFunc func, void* userData);
+    void updateImpl(const KeyView key, litestore_blob_t blobIn);
+    template <typename Func>
+    void runInTx(Func&& func);
 
-    ErrorFunc m_errorFunc = {};
+    // declared first, the handle may report errors while closing
+    std::unique_ptr<detail::Context> m_context = nullptr;
     detail::Handle m_litestore = nullptr; 
 };
 
@@ -197,6 +787,21 @@ struct BlobInput
         return litestore_make_blob(&value, sizeof(T));
     }
 };
+/**
+ * Template to write a blob read from Litestore to T (output).
+ * This can be specialized for custom types.
+ *
+ * The size of the stored blob is passed to prepare() before
+ * any data is copied, so variable length types can allocate
+ * the exact amount of storage once.
+ *
+ * Specializations written for the earlier protocol, which
+ * only have a data() method returning the destination, still
+ * work. The stored blob is copied there without a size check,
+ * as before, so prefer prepare() in new specializations.
+ *
+ * The provided templates work for POD types.
+ */
 template <typename T>
 struct BlobOutput
 {
@@ -208,9 +813,15 @@ struct BlobOutput
     BlobOutput(T& v)
         : value(v)
     {}
-    void* data()
+    /**
+     * @param size The size of the stored blob in bytes.
+     * @return Destination for size bytes, or nullptr if the
+     *         blob can not be stored to the value.
+     *         Must not be nullptr for a valid empty blob.
+     */
+    void* prepare(const std::size_t size)
     {
-        return &value;
+        return size == sizeof(T) ? &value : nullptr;
     }
 };
 // Specialization for nullptr_t
@@ -228,15 +839,146 @@ template <>
 struct BlobOutput<std::nullptr_t>
 {
     BlobOutput(std::nullptr_t&) {};
-    void* data()
+    void* prepare(const std::size_t)
     {
         return nullptr;
     }
 };
+// Specialization for std::string
+template <>
+struct BlobInput<std::string>
+{
+    const std::string& value;
+
+    BlobInput(const std::string& v)
+        : value(v)
+    {}
+    litestore_blob_t blob()
+    {
+        return litestore_make_blob(value.data(), value.size());
+    }
+};
+template <>
+struct BlobOutput<std::string>
+{
+    std::string& value;
+
+    BlobOutput(std::string& v)
+        : value(v)
+    {}
+    void* prepare(const std::size_t size)
+    {
+        value.resize(size);
+        return &value[0];
+    }
+};
+// Specialization for std::vector of POD types
+template <typename T>
+struct BlobInput<std::vector<T>>
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Type must be POD!");
+    const std::vector<T>& value;
+
+    BlobInput(const std::vector<T>& v)
+        : value(v)
+    {}
+    litestore_blob_t blob()
+    {
+        // empty vector may have no storage, nullptr would store a null
+        return litestore_make_blob(
+            value.empty() ? static_cast<const void*>("") : value.data(),
+            value.size() * sizeof(T));
+    }
+};
+template <typename T>
+struct BlobOutput<std::vector<T>>
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Type must be POD!");
+    std::vector<T>& value;
+
+    BlobOutput(std::vector<T>& v)
+        : value(v)
+    {}
+    void* prepare(const std::size_t size)
+    {
+        if (size % sizeof(T) != 0)
+        {
+            return nullptr;
+        }
+        value.resize(size / sizeof(T));
+        return value.empty() ?
+            static_cast<void*>(&value) : static_cast<void*>(value.data());
+    }
+};
+// std::array of POD types is POD and handled by the generic templates.
+
+namespace detail
+{
+/**
+ * @return The destination from BlobOutput::prepare().
+ */
+template <typename Output>
+auto prepareOutput(Output& bo, const std::size_t size, int)
+    -> decltype(bo.prepare(size))
+{
+    return bo.prepare(size);
+}
+/**
+ * @return The destination from BlobOutput::data() for
+ *         specializations without prepare().
+ */
+template <typename Output>
+void* prepareOutput(Output& bo, const std::size_t, long)
+{
+    return bo.data();
+}
+
+/**
+ * litestore_read callback that writes the blob via BlobOutput<T>.
+ */
+template <typename T>
+int readBlob(litestore_blob_t value, void* user_data) noexcept
+{
+    try
+    {
+        auto bo = reinterpret_cast<BlobOutput<T>*>(user_data);
+        void* dst = prepareOutput(*bo, value.size, 0);
+        if (!dst)
+        {
+            return LITESTORE_ERR;
+        }
+        if (value.size > 0)
+        {
+            std::memcpy(dst, value.data, value.size);
+        }
+
+        return LITESTORE_OK;
+    }
+    catch (...)
+    {}
+    return LITESTORE_ERR;
+}
+}  // namespace detail
+
+template <typename T>
+inline
+void WriteBatch::create(const KeyView key, const T& value)
+{
+    BlobInput<T> bi(value);
+    add(Op::CREATE, key, bi.blob());
+}
+
+template <typename T>
+inline
+void WriteBatch::update(const KeyView key, const T& value)
+{
+    BlobInput<T> bi(value);
+    add(Op::UPDATE, key, bi.blob());
+}
 
 template <typename T>
 inline
-void Litestore::create(const std::string& key, const T& value)
+void Litestore::create(const KeyView key, const T& value)
 {
     using namespace lscpp;
     BlobInput<T> bi(value);
@@ -245,19 +987,22 @@ void Litestore::create(const std::string& key, const T& value)
 
 template <typename T>
 inline
-T Litestore::read(const std::string& key)
+T Litestore::read(const KeyView key)
 {
     using namespace lscpp;
     T value;
     BlobOutput<T> bo(value);
-    readImpl(key, bo.data());
+    readImpl(key,
+             std::is_same<T, std::nullptr_t>::value ?
+                 nullptr : &detail::readBlob<T>,
+             &bo);
 
     return value;
 }
 
 template <typename T>
 inline
-void Litestore::update(const std::string& key, const T& value)
+void Litestore::update(const KeyView key, const T& value)
 {
     using namespace lscpp;
     BlobInput<T> bi(value);
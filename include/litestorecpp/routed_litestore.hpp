@@ -0,0 +1,127 @@
+/**
+ * Copyright (c) 2018 Markku Linnoskivi
+ *
+ * See the file LICENSE for copying permission.
+ */
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "litestorecpp/litestore_pool.hpp"
+#include "litestorecpp/litestorecpp.hpp"
+
+namespace lscpp
+{
+/**
+ * Thread safe Litestore routing reads and writes to separate handles.
+ *
+ * The file is switched to the WAL journal mode, in which readers
+ * see the last committed state and are not blocked by a write
+ * transaction in progress. Writes are serialized on a single
+ * writer handle, reads are served by a pool of reader handles.
+ *
+ * Functions called back during reads must not use the instance,
+ * that could exhaust the reader pool.
+ */
+class RoutedLitestore
+{
+public:
+    /**
+     * Exclusive use of the writer handle, e.g. for transactions.
+     * Other writes wait until the lease is destroyed.
+     */
+    class Writer
+    {
+    public:
+        Litestore& operator*() noexcept { return *m_store; }
+        Litestore* operator->() noexcept { return m_store; }
+
+    private:
+        friend class RoutedLitestore;
+
+        Writer(std::mutex& mutex, Litestore& store)
+            : m_lock(mutex),
+              m_store(&store)
+        {}
+
+        std::unique_lock<std::mutex> m_lock;
+        Litestore* m_store;
+    };
+
+    /**
+     * Switches filename to WAL and opens the handles.
+     *
+     * @param filename The Litestore filename, not ":memory:".
+     * @param readers Number of reader handles, at least one.
+     * @param errFunc The error function given to every handle.
+     * @throws std::runtime_error if the journal mode can not be
+     *         changed or a handle can not be opened.
+     */
+    RoutedLitestore(std::string filename,
+                    const std::size_t readers,
+                    Litestore::ErrorFunc errFunc = Litestore::ErrorFunc());
+    RoutedLitestore(const RoutedLitestore&) = delete;
+    RoutedLitestore& operator=(const RoutedLitestore&) = delete;
+    /**
+     * Lease the writer handle.
+     * Blocks while another thread holds it.
+     */
+    Writer writer();
+    /**
+     * @return The pool of reader handles.
+     */
+    LitestorePool& readers() noexcept { return m_readers; }
+
+    /** Writes, @see Litestore */
+    template <typename T>
+    void create(const KeyView key, const T& value);
+    template <typename T>
+    void update(const KeyView key, const T& value);
+    void del(const KeyView key);
+    void write(const WriteBatch& batch);
+
+    /** Reads, @see Litestore */
+    template <typename T>
+    T read(const KeyView key);
+    void readView(const KeyView key, const Litestore::ViewFunc& func);
+    bool exists(const KeyView key);
+    std::vector<std::string> keys(const KeyView pattern);
+    void keys(const KeyView pattern, const Litestore::KeyFunc& func);
+    std::size_t count(const KeyView pattern);
+    void forEach(const KeyView pattern, const Litestore::EntryFunc& func);
+    std::vector<std::string> scanPrefix(const KeyView prefix);
+    std::vector<std::string> scanRange(const KeyView begin,
+                                       const KeyView end,
+                                       const std::size_t limit = 0);
+
+private:
+    std::mutex m_writerMutex;
+    Litestore m_writer;
+    LitestorePool m_readers;
+};
+
+template <typename T>
+inline
+void RoutedLitestore::create(const KeyView key, const T& value)
+{
+    writer()->create(key, value);
+}
+
+template <typename T>
+inline
+void RoutedLitestore::update(const KeyView key, const T& value)
+{
+    writer()->update(key, value);
+}
+
+template <typename T>
+inline
+T RoutedLitestore::read(const KeyView key)
+{
+    return m_readers.acquire()->read<T>(key);
+}
+
+}  // namespace lscpp
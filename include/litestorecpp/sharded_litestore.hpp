@@ -0,0 +1,149 @@
+/**
+ * Copyright (c) 2018 Markku Linnoskivi
+ *
+ * See the file LICENSE for copying permission.
+ */
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "litestorecpp/litestorecpp.hpp"
+
+namespace lscpp
+{
+/**
+ * Thread safe Litestore partitioning keys over several files.
+ *
+ * Each key is stored in the shard chosen by its hash, so
+ * writes to different shards proceed in parallel. The shard
+ * of a key depends on the number of shards, which must not
+ * change for existing files.
+ *
+ * Transactions are per shard, see shard().
+ */
+class ShardedLitestore
+{
+public:
+    using ShardFunc = std::function<void(std::size_t shard, Litestore& store)>;
+
+    /**
+     * Exclusive use of one shard, e.g. for a transaction.
+     * Other operations on the shard wait until the lease is destroyed.
+     */
+    class Lease
+    {
+    public:
+        Litestore& operator*() noexcept { return *m_store; }
+        Litestore* operator->() noexcept { return m_store; }
+
+    private:
+        friend class ShardedLitestore;
+
+        Lease(std::mutex& mutex, Litestore& store)
+            : m_lock(mutex),
+              m_store(&store)
+        {}
+
+        std::unique_lock<std::mutex> m_lock;
+        Litestore* m_store;
+    };
+
+    /**
+     * Opens the files basename.0 ... basename.(shards - 1).
+     *
+     * @param basename The common part of the filenames.
+     * @param shards Number of shards, at least one.
+     * @throws std::runtime_error if a file can not be opened.
+     */
+    ShardedLitestore(const std::string& basename, const std::size_t shards);
+    /**
+     * @param filenames The file of each shard, in a fixed order.
+     * @throws std::runtime_error if a file can not be opened
+     *         or filenames is empty.
+     */
+    explicit ShardedLitestore(const std::vector<std::string>& filenames);
+    ShardedLitestore(const ShardedLitestore&) = delete;
+    ShardedLitestore& operator=(const ShardedLitestore&) = delete;
+    /**
+     * @return Number of shards.
+     */
+    std::size_t shards() const noexcept { return m_shards.size(); }
+    /**
+     * @return Index of the shard storing key.
+     */
+    std::size_t shardOf(const KeyView key) const noexcept;
+    /**
+     * Lease the given shard.
+     * Blocks while another thread uses it.
+     */
+    Lease shard(const std::size_t i);
+    /**
+     * Call func for every shard, each on a thread of its own
+     * with the shard leased. Exceptions are propagated after
+     * every call has returned, the first one is rethrown.
+     */
+    void forEachShard(const ShardFunc& func);
+
+    /** Operations on the shard of key, @see Litestore */
+    template <typename T>
+    void create(const KeyView key, const T& value);
+    template <typename T>
+    T read(const KeyView key);
+    template <typename T>
+    void update(const KeyView key, const T& value);
+    void del(const KeyView key);
+    bool exists(const KeyView key);
+    /**
+     * Get the keys matching pattern from every shard.
+     * Shards are listed one at a time on the calling thread.
+     *
+     * @return The keys in ascending order.
+     * @throws std::runtime_error if operation fails.
+     */
+    std::vector<std::string> keys(const KeyView pattern);
+    /**
+     * @return Number of keys matching pattern in every shard.
+     */
+    std::size_t count(const KeyView pattern);
+
+private:
+    struct Shard
+    {
+        explicit Shard(Litestore store)
+            : store(std::move(store))
+        {}
+
+        std::mutex mutex;
+        Litestore store;
+    };
+
+    std::vector<std::unique_ptr<Shard>> m_shards;
+};
+
+template <typename T>
+inline
+void ShardedLitestore::create(const KeyView key, const T& value)
+{
+    shard(shardOf(key))->create(key, value);
+}
+
+template <typename T>
+inline
+T ShardedLitestore::read(const KeyView key)
+{
+    return shard(shardOf(key))->read<T>(key);
+}
+
+template <typename T>
+inline
+void ShardedLitestore::update(const KeyView key, const T& value)
+{
+    shard(shardOf(key))->update(key, value);
+}
+
+}  // namespace lscpp
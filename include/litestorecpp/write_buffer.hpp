@@ -0,0 +1,120 @@
+/**
+ * Copyright (c) 2018 Markku Linnoskivi
+ *
+ * See the file LICENSE for copying permission.
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+
+#include "litestorecpp/litestorecpp.hpp"
+
+namespace lscpp
+{
+namespace detail
+{
+/**
+ * The pending writes of a WriteBuffer, shared with
+ * the hooks of its transaction.
+ */
+struct PendingWrites
+{
+    struct Entry
+    {
+        bool deleted;
+        bool null;
+        std::string value;
+    };
+
+    Litestore* store;
+    std::unordered_map<std::string, Entry> entries;
+};
+}
+
+/**
+ * Write-back buffer for a transaction.
+ *
+ * Keeps only the last value written per key and writes them
+ * to the store once, right before the transaction commits.
+ * If the transaction is rolled back the writes are discarded.
+ * Reads of buffered keys are served from the buffer.
+ *
+ * The buffer may be destroyed before the transaction ends,
+ * the store must stay in place until it does.
+ */
+class WriteBuffer
+{
+public:
+    /**
+     * @param store The store written to.
+     * @param tx Open transaction of store.
+     * @throws std::runtime_error if tx is not open.
+     */
+    WriteBuffer(Litestore& store, Transaction& tx);
+    WriteBuffer(const WriteBuffer&) = delete;
+    WriteBuffer& operator=(const WriteBuffer&) = delete;
+    /**
+     * Buffer an update of key.
+     * The template type T must have valid specialization for
+     * BlobInput class.
+     */
+    template <typename T>
+    void update(const KeyView key, const T& value);
+    /**
+     * Buffer a delete of key.
+     */
+    void del(const KeyView key);
+    /**
+     * Read a blob of type T with key, from the buffer if
+     * written, otherwise from the store.
+     * @see Litestore::read()
+     */
+    template <typename T>
+    T read(const KeyView key);
+    /**
+     * Write the buffered values to the store now.
+     * @throws std::runtime_error if operation fails.
+     */
+    void flush();
+    /**
+     * @return Number of keys buffered.
+     */
+    std::size_t size() const noexcept { return m_pending->entries.size(); }
+
+private:
+    using ReadFunc = int (*)(litestore_blob_t value, void* user_data);
+
+    void put(const KeyView key, litestore_blob_t value);
+    bool readImpl(const KeyView key, ReadFunc func, void* userData);
+
+    std::shared_ptr<detail::PendingWrites> m_pending;
+};
+
+template <typename T>
+inline
+void WriteBuffer::update(const KeyView key, const T& value)
+{
+    BlobInput<T> bi(value);
+    put(key, bi.blob());
+}
+
+template <typename T>
+inline
+T WriteBuffer::read(const KeyView key)
+{
+    T value;
+    BlobOutput<T> bo(value);
+    const bool buffered = readImpl(
+        key,
+        std::is_same<T, std::nullptr_t>::value ?
+            nullptr : &detail::readBlob<T>,
+        &bo);
+
+    return buffered ? value : m_pending->store->read<T>(key);
+}
+
+}  // namespace lscpp
@@ -0,0 +1,98 @@
+/**
+ * Copyright (c) 2018 Markku Linnoskivi
+ *
+ * See the file LICENSE for copying permission.
+ */
+#include "litestorecpp/async_litestore.hpp"
+
+#include <stdexcept>
+
+namespace lscpp
+{
+AsyncLitestore::AsyncLitestore(const char* filename,
+                               Litestore::ErrorFunc errFunc)
+    : AsyncLitestore(Litestore(filename, std::move(errFunc)))
+{}
+
+AsyncLitestore::AsyncLitestore(Litestore store)
+    : m_store(std::move(store)),
+      m_thread(&AsyncLitestore::run, this)
+{}
+
+AsyncLitestore::~AsyncLitestore()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_queued.notify_one();
+    m_thread.join();
+}
+
+void AsyncLitestore::post(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_queued.notify_one();
+}
+
+std::future<void> AsyncLitestore::del(const KeyView key)
+{
+    return submit([key = key.str()](Litestore& store)
+    {
+        store.del(key);
+    });
+}
+
+std::future<void> AsyncLitestore::write(WriteBatch batch)
+{
+    return submit([batch = std::move(batch)](Litestore& store)
+    {
+        store.write(batch);
+    });
+}
+
+std::future<std::vector<std::string>> AsyncLitestore::keys(const KeyView pattern)
+{
+    return submit([pattern = pattern.str()](Litestore& store)
+    {
+        return store.keys(pattern);
+    });
+}
+
+void AsyncLitestore::run()
+{
+    std::deque<Task> tasks;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_queued.wait(lock, [this]
+            {
+                return m_stop || !m_tasks.empty();
+            });
+            if (m_tasks.empty())
+            {
+                return;
+            }
+            // take everything queued to release the lock for the run
+            tasks.swap(m_tasks);
+        }
+        for (auto& task : tasks)
+        {
+            try
+            {
+                task(m_store);
+            }
+            catch (...)
+            {
+                // posted tasks have no one to report to
+            }
+        }
+        tasks.clear();
+    }
+}
+
+}  // namespace lscpp
@@ -0,0 +1,85 @@
+/**
+ * Copyright (c) 2018 Markku Linnoskivi
+ *
+ * See the file LICENSE for copying permission.
+ */
+#include "litestorecpp/bloom_filter.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace lscpp
+{
+namespace
+{
+/**
+ * Second hash for double hashing. The filter size is a power
+ * of two, so an odd step visits every bit before repeating.
+ */
+inline
+std::uint64_t rehash(const std::uint64_t h) noexcept
+{
+    return detail::mixHash(h) | 1;
+}
+
+std::size_t nextPowerOfTwo(const std::size_t n) noexcept
+{
+    std::size_t p = 1;
+    while (p < n)
+    {
+        p <<= 1;
+    }
+    return p;
+}
+
+}  // namespace
+
+BloomFilter::BloomFilter(const std::size_t expectedKeys,
+                         const double falsePositiveRate)
+{
+    const double ln2 = std::log(2.0);
+    const double n = static_cast<double>(std::max<std::size_t>(expectedKeys, 1));
+    const double p = std::min(std::max(falsePositiveRate, 1e-9), 0.5);
+    const double m = std::ceil(-n * std::log(p) / (ln2 * ln2));
+    m_numBits = nextPowerOfTwo(
+        std::max<std::size_t>(static_cast<std::size_t>(m), 64));
+    const double bits = static_cast<double>(m_numBits);
+    m_numHashes = std::min<std::size_t>(
+        std::max<std::size_t>(
+            static_cast<std::size_t>(std::lround(bits / n * ln2)), 1),
+        16);
+    m_words.assign((m_numBits + 63) / 64, 0);
+}
+
+void BloomFilter::add(const KeyView key) noexcept
+{
+    const std::uint64_t h1 = KeyHash()(key);
+    const std::uint64_t h2 = rehash(h1);
+    for (std::size_t i = 0; i < m_numHashes; ++i)
+    {
+        const auto bit = (h1 + i * h2) & (m_numBits - 1);
+        m_words[bit / 64] |= std::uint64_t(1) << (bit % 64);
+    }
+}
+
+bool BloomFilter::mayContain(const KeyView key) const noexcept
+{
+    const std::uint64_t h1 = KeyHash()(key);
+    const std::uint64_t h2 = rehash(h1);
+    for (std::size_t i = 0; i < m_numHashes; ++i)
+    {
+        const auto bit = (h1 + i * h2) & (m_numBits - 1);
+        if (!(m_words[bit / 64] & (std::uint64_t(1) << (bit % 64))))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void BloomFilter::clear() noexcept
+{
+    std::fill(m_words.begin(), m_words.end(), 0);
+}
+
+}  // namespace lscpp
@@ -0,0 +1,330 @@
+/**
+ * Copyright (c) 2018 Markku Linnoskivi
+ *
+ * See the file LICENSE for copying permission.
+ */
+#include "litestorecpp/cached_litestore.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace lscpp
+{
+namespace
+{
+// number of keys a preload thread claims at a time
+const std::size_t PRELOAD_CHUNK = 64;
+
+}  // namespace
+
+ValueCache::ValueCache(const std::size_t budget)
+    : m_budget(budget)
+{}
+
+const std::string* ValueCache::get(const KeyView key)
+{
+    const auto it = m_index.find(key);
+    if (it == m_index.end())
+    {
+        return nullptr;
+    }
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+
+    return &it->second->value;
+}
+
+void ValueCache::put(const KeyView key, const BlobView value)
+{
+    erase(key);
+
+    const auto size = key.size() + value.size();
+    if (size > m_budget)
+    {
+        return;
+    }
+    evict(size);
+
+    const auto data = static_cast<const char*>(value.data());
+    m_lru.push_front(Node{key.str(), std::string(data, data + value.size())});
+    m_index.emplace(KeyView(m_lru.front().key), m_lru.begin());
+    m_bytes += size;
+}
+
+void ValueCache::erase(const KeyView key)
+{
+    const auto it = m_index.find(key);
+    if (it == m_index.end())
+    {
+        return;
+    }
+    const auto node = it->second;
+    m_bytes -= node->key.size() + node->value.size();
+    m_index.erase(it);
+    m_lru.erase(node);
+}
+
+void ValueCache::clear() noexcept
+{
+    m_index.clear();
+    m_lru.clear();
+    m_bytes = 0;
+}
+
+void ValueCache::evict(const std::size_t needed)
+{
+    while (!m_lru.empty() && m_bytes + needed > m_budget)
+    {
+        erase(m_lru.back().key);
+    }
+}
+
+
+ShardedValueCache::ShardedValueCache(const std::size_t budget,
+                                     const std::size_t shards)
+{
+    const auto n = std::max<std::size_t>(shards, 1);
+    m_shards.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        m_shards.emplace_back(new Shard(budget / n));
+    }
+}
+
+std::uint64_t ShardedValueCache::generation(const KeyView key) const
+{
+    auto& shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    return shard.generation;
+}
+
+void ShardedValueCache::put(const KeyView key,
+                            const BlobView value,
+                            const std::uint64_t generation)
+{
+    auto& shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.generation == generation)
+    {
+        shard.cache.put(key, value);
+    }
+}
+
+void ShardedValueCache::erase(const KeyView key)
+{
+    auto& shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.cache.erase(key);
+    ++shard.generation;
+}
+
+void ShardedValueCache::clear()
+{
+    for (auto& shard : m_shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->cache.clear();
+        ++shard->generation;
+    }
+}
+
+ShardedValueCache::Stats ShardedValueCache::stats(const std::size_t shard) const
+{
+    const auto& s = *m_shards.at(shard);
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    return Stats{s.hits, s.misses, s.cache.size(), s.cache.bytes()};
+}
+
+std::size_t ShardedValueCache::size() const
+{
+    std::size_t n = 0;
+    for (const auto& shard : m_shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        n += shard->cache.size();
+    }
+    return n;
+}
+
+ShardedValueCache::Shard& ShardedValueCache::shardOf(const KeyView key) const
+{
+    return *m_shards[KeyHash()(key) % m_shards.size()];
+}
+
+
+CachedLitestore::CachedLitestore(const char* filename,
+                                 const std::size_t budget)
+    : CachedLitestore(Litestore(filename), budget)
+{}
+
+CachedLitestore::CachedLitestore(Litestore store, const std::size_t budget)
+    : CachedLitestore(std::move(store),
+                      std::make_shared<ShardedValueCache>(budget, 1))
+{}
+
+CachedLitestore::CachedLitestore(Litestore store,
+                                 std::shared_ptr<ShardedValueCache> cache)
+    : m_store(std::move(store)),
+      m_cache(std::move(cache))
+{}
+
+void CachedLitestore::close() noexcept
+{
+    m_store.close();
+    m_cache->clear();
+}
+
+Transaction CachedLitestore::createTx()
+{
+    auto tx = m_store.createTx();
+    auto dirty = std::make_shared<std::vector<std::string>>();
+    auto cache = m_cache;
+    // values cached during the transaction may be uncommitted and
+    // other instances sharing the cache may have cached old values
+    const auto drop = [cache, dirty]
+    {
+        for (const auto& key : *dirty)
+        {
+            cache->erase(key);
+        }
+    };
+    tx.onRollback(drop);
+    tx.onCommit(drop);
+    m_dirty = std::move(dirty);
+
+    return tx;
+}
+
+void CachedLitestore::del(const KeyView key)
+{
+    m_store.del(key);
+    written(key);
+}
+
+void CachedLitestore::invalidate(const KeyView key)
+{
+    m_cache->erase(key);
+}
+
+void CachedLitestore::clear()
+{
+    m_cache->clear();
+}
+
+std::size_t CachedLitestore::preload(const KeyView pattern,
+                                     const std::size_t threads,
+                                     const ProgressFunc& progress)
+{
+    if (m_store.inTx())
+    {
+        return 0;
+    }
+    KeyArena keys;
+    m_store.keys(pattern, keys);
+    const auto total = keys.size();
+    const auto filename = m_store.filename();
+    const auto shared = detail::isPrivateDatabase(filename);
+    const auto chunks = (total + PRELOAD_CHUNK - 1) / PRELOAD_CHUNK;
+    const auto n = std::min<std::size_t>(
+        shared ? 1
+        : threads ? threads
+                  : std::max(std::thread::hardware_concurrency(), 1u),
+        chunks);
+
+    std::atomic<std::size_t> next(0);
+    std::atomic<std::size_t> loaded(0);
+    std::mutex mutex;
+    std::size_t done = 0;
+
+    detail::runWorkers(n, [&](const std::size_t, const std::atomic<bool>& stop)
+    {
+        std::unique_ptr<Litestore> own;
+        if (!shared)
+        {
+            own.reset(new Litestore(filename.c_str()));
+        }
+        auto& store = own ? *own : m_store;
+
+        while (!stop)
+        {
+            const auto begin = next.fetch_add(PRELOAD_CHUNK);
+            if (begin >= total)
+            {
+                return;
+            }
+            const auto end = std::min(begin + PRELOAD_CHUNK, total);
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto key = keys[i];
+                const auto generation = m_cache->generation(key);
+                const auto read = store.tryReadView(key, [&](BlobView value)
+                {
+                    m_cache->put(key, value, generation);
+                });
+                if (read)
+                {
+                    ++loaded;
+                }
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            done += end - begin;
+            if (progress && !stop)
+            {
+                progress(done, total);
+            }
+        }
+    });
+    return loaded;
+}
+
+void CachedLitestore::readImpl(const KeyView key,
+                               ReadFunc func,
+                               void* userData)
+{
+    auto decode = [&](const void* data, const std::size_t size)
+    {
+        if (func(litestore_make_blob(data, size), userData) != LITESTORE_OK)
+        {
+            throw std::runtime_error("Litestore error: " +
+                                     std::to_string(LITESTORE_ERR));
+        }
+    };
+
+    const auto hit = m_cache->get(key, [&](BlobView value)
+    {
+        decode(value.data(), value.size());
+    });
+    if (hit)
+    {
+        m_store.recordAccess(key);
+        return;
+    }
+    // values read in a transaction may be uncommitted, and other
+    // instances sharing the cache must not see them
+    const auto cacheable = !m_store.inTx();
+    const auto generation = m_cache->generation(key);
+    m_store.readView(key, [&](BlobView value)
+    {
+        if (cacheable)
+        {
+            m_cache->put(key, value, generation);
+        }
+        decode(value.data(), value.size());
+    });
+}
+
+void CachedLitestore::written(const KeyView key)
+{
+    m_cache->erase(key);
+    // reads later in the transaction may cache uncommitted values
+    if (m_dirty && m_store.inTx())
+    {
+        m_dirty->push_back(key.str());
+    }
+}
+
+}  // namespace lscpp
@@ -0,0 +1,55 @@
+/**
+ * Copyright (c) 2018 Markku Linnoskivi
+ *
+ * See the file LICENSE for copying permission.
+ */
+#include "litestorecpp/coro_litestore.hpp"
+
+#include <algorithm>
+
+namespace lscpp
+{
+KeyGenerator::KeyGenerator(AsyncLitestore& executor, std::string pattern)
+    : m_executor(executor),
+      m_pattern(std::move(pattern))
+{}
+
+Operation<bool> KeyGenerator::next()
+{
+    if (m_started)
+    {
+        return Operation<bool>(++m_pos < m_keys.size());
+    }
+    return Operation<bool>(m_executor, [this](Litestore& store)
+    {
+        m_keys = store.keys(m_pattern);
+        std::sort(m_keys.begin(), m_keys.end());
+        m_pos = 0;
+        m_started = true;
+
+        return !m_keys.empty();
+    });
+}
+
+Operation<void> CoroLitestore::delAsync(const KeyView key)
+{
+    return Operation<void>(m_executor, [key = key.str()](Litestore& store)
+    {
+        store.del(key);
+    });
+}
+
+Operation<void> CoroLitestore::writeAsync(WriteBatch batch)
+{
+    return Operation<void>(m_executor, [batch = std::move(batch)](Litestore& store)
+    {
+        store.write(batch);
+    });
+}
+
+KeyGenerator CoroLitestore::keysAsync(const KeyView pattern)
+{
+    return KeyGenerator(m_executor, pattern.str());
+}
+
+}  // namespace lscpp
@@ -0,0 +1,160 @@
+/**
+ * Copyright (c) 2018 Markku Linnoskivi
+ *
+ * See the file LICENSE for copying permission.
+ */
+#include "litestorecpp/group_commit_writer.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+namespace lscpp
+{
+GroupCommitWriter::GroupCommitWriter(const char* filename,
+                                     const std::size_t maxBatch)
+    : GroupCommitWriter(Litestore(filename), maxBatch)
+{}
+
+GroupCommitWriter::GroupCommitWriter(Litestore store,
+                                     const std::size_t maxBatch)
+    : m_store(std::move(store)),
+      m_maxBatch(std::max<std::size_t>(maxBatch, 1)),
+      m_head(nullptr),
+      m_sleeping(false),
+      m_stop(false),
+      m_commits(0),
+      m_thread(&GroupCommitWriter::run, this)
+{}
+
+GroupCommitWriter::~GroupCommitWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+std::future<void> GroupCommitWriter::del(const KeyView key)
+{
+    WriteBatch batch;
+    batch.del(key);
+
+    return write(std::move(batch));
+}
+
+std::future<void> GroupCommitWriter::write(WriteBatch batch)
+{
+    return push(new Node{std::move(batch), std::promise<void>(), nullptr});
+}
+
+std::future<void> GroupCommitWriter::push(Node* node)
+{
+    auto future = node->done.get_future();
+
+    node->next = m_head.load(std::memory_order_relaxed);
+    while (!m_head.compare_exchange_weak(node->next, node))
+    {}
+    // pairs with the check of m_head after m_sleeping is set in run()
+    if (m_sleeping)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_wake.notify_one();
+    }
+    return future;
+}
+
+void GroupCommitWriter::run()
+{
+    for (;;)
+    {
+        auto pushed = m_head.exchange(nullptr);
+        if (!pushed)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_sleeping = true;
+            m_wake.wait(lock, [this]
+            {
+                return m_stop || m_head.load() != nullptr;
+            });
+            m_sleeping = false;
+            if (m_head.load() == nullptr)
+            {
+                return;
+            }
+            continue;
+        }
+        // the stack is newest first, reverse to commit in order
+        Node* first = nullptr;
+        while (pushed)
+        {
+            const auto next = pushed->next;
+            pushed->next = first;
+            first = pushed;
+            pushed = next;
+        }
+        while (first)
+        {
+            auto last = first;
+            for (std::size_t n = 1; n < m_maxBatch && last->next; ++n)
+            {
+                last = last->next;
+            }
+            const auto rest = last->next;
+            last->next = nullptr;
+            commit(first, last);
+            first = rest;
+        }
+    }
+}
+
+void GroupCommitWriter::commit(Node* first, Node* last)
+{
+    std::exception_ptr error;
+    try
+    {
+        auto tx = m_store.createTx();
+        for (auto node = first; node; node = node->next)
+        {
+            m_store.write(node->batch);
+        }
+        tx.commit();
+        ++m_commits;
+    }
+    catch (...)
+    {
+        // the transaction has been rolled back
+        error = std::current_exception();
+    }
+    for (auto node = first; node; )
+    {
+        if (error && first != last)
+        {
+            try
+            {
+                m_store.write(node->batch);
+                ++m_commits;
+                node->done.set_value();
+            }
+            catch (...)
+            {
+                node->done.set_exception(std::current_exception());
+            }
+        }
+        else if (error)
+        {
+            node->done.set_exception(error);
+        }
+        else
+        {
+            node->done.set_value();
+        }
+        const auto next = node->next;
+        delete node;
+        node = next;
+    }
+}
+
+}  // namespace lscpp
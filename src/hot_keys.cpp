@@ -0,0 +1,172 @@
+/**
+ * Copyright (c) 2018 Markku Linnoskivi
+ *
+ * See the file LICENSE for copying permission.
+ */
+#include "litestorecpp/hot_keys.hpp"
+
+#include <algorithm>
+#include <initializer_list>
+#include <limits>
+
+namespace lscpp
+{
+HotKeyTracker::HotKeyTracker(const std::size_t sampleEvery,
+                             const std::size_t capacity,
+                             const std::size_t width,
+                             const std::size_t depth)
+    : m_sampleEvery(std::max<std::size_t>(sampleEvery, 1)),
+      m_capacity(std::max<std::size_t>(capacity, 1)),
+      m_width(std::max<std::size_t>(width, 1)),
+      m_depth(std::max<std::size_t>(depth, 1)),
+      m_counters(m_width * m_depth, 0)
+{
+    m_slots.reserve(m_capacity);
+    m_heap.reserve(m_capacity);
+}
+
+void HotKeyTracker::record(const KeyView key)
+{
+    if (m_accesses++ % m_sampleEvery != 0)
+    {
+        return;
+    }
+    const auto count = add(key);
+
+    const auto it = m_index.find(key);
+    if (it != m_index.end())
+    {
+        auto& candidate = m_slots[it->second];
+        candidate.count = count;
+        siftDown(candidate.heapPos);
+        return;
+    }
+    if (m_slots.size() < m_capacity)
+    {
+        const auto slot = m_slots.size();
+        m_slots.push_back(Candidate{key.str(), count, m_heap.size()});
+        m_heap.push_back(slot);
+        m_index.emplace(KeyView(m_slots.back().key), slot);
+        siftUp(m_heap.size() - 1);
+        return;
+    }
+    // replace the least accessed candidate if key is hotter
+    const auto slot = m_heap.front();
+    auto& candidate = m_slots[slot];
+    if (count <= candidate.count)
+    {
+        return;
+    }
+    m_index.erase(KeyView(candidate.key));
+    candidate.key.assign(key.data(), key.size());
+    candidate.count = count;
+    m_index.emplace(KeyView(candidate.key), slot);
+    siftDown(0);
+}
+
+std::uint64_t HotKeyTracker::estimate(const KeyView key) const noexcept
+{
+    const std::uint64_t h1 = KeyHash()(key);
+    const std::uint64_t h2 = detail::mixHash(h1) | 1;
+    auto count = std::numeric_limits<std::uint64_t>::max();
+    for (std::size_t row = 0; row < m_depth; ++row)
+    {
+        const auto col = (h1 + row * h2) % m_width;
+        count = std::min(count, m_counters[row * m_width + col]);
+    }
+    return count * m_sampleEvery;
+}
+
+std::vector<HotKey> HotKeyTracker::top(const std::size_t k) const
+{
+    std::vector<HotKey> result;
+    result.reserve(m_slots.size());
+    for (const auto& c : m_slots)
+    {
+        result.push_back(HotKey{c.key, c.count * m_sampleEvery});
+    }
+    const auto n = std::min(k, result.size());
+    std::partial_sort(result.begin(), result.begin() + n, result.end(),
+                      [](const HotKey& lhs, const HotKey& rhs)
+                      {
+                          return lhs.count > rhs.count;
+                      });
+    result.resize(n);
+
+    return result;
+}
+
+void HotKeyTracker::clear() noexcept
+{
+    std::fill(m_counters.begin(), m_counters.end(), 0);
+    m_index.clear();
+    m_heap.clear();
+    m_slots.clear();
+    m_accesses = 0;
+}
+
+std::uint64_t HotKeyTracker::add(const KeyView key) noexcept
+{
+    const std::uint64_t h1 = KeyHash()(key);
+    const std::uint64_t h2 = detail::mixHash(h1) | 1;
+    auto count = std::numeric_limits<std::uint64_t>::max();
+    for (std::size_t row = 0; row < m_depth; ++row)
+    {
+        const auto col = (h1 + row * h2) % m_width;
+        auto& counter = m_counters[row * m_width + col];
+        count = std::min(count, ++counter);
+    }
+    return count;
+}
+
+bool HotKeyTracker::less(const std::size_t a, const std::size_t b) const noexcept
+{
+    return m_slots[m_heap[a]].count < m_slots[m_heap[b]].count;
+}
+
+void HotKeyTracker::place(const std::size_t pos, const std::size_t slot) noexcept
+{
+    m_heap[pos] = slot;
+    m_slots[slot].heapPos = pos;
+}
+
+void HotKeyTracker::siftUp(std::size_t pos) noexcept
+{
+    while (pos > 0)
+    {
+        const auto parent = (pos - 1) / 2;
+        if (!less(pos, parent))
+        {
+            break;
+        }
+        const auto slot = m_heap[pos];
+        place(pos, m_heap[parent]);
+        place(parent, slot);
+        pos = parent;
+    }
+}
+
+void HotKeyTracker::siftDown(std::size_t pos) noexcept
+{
+    for (;;)
+    {
+        auto smallest = pos;
+        for (const auto child : {2 * pos + 1, 2 * pos + 2})
+        {
+            if (child < m_heap.size() && less(child, smallest))
+            {
+                smallest = child;
+            }
+        }
+        if (smallest == pos)
+        {
+            break;
+        }
+        const auto slot = m_heap[pos];
+        place(pos, m_heap[smallest]);
+        place(smallest, slot);
+        pos = smallest;
+    }
+}
+
+}  // namespace lscpp
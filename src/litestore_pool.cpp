@@ -0,0 +1,163 @@
+/**
+ * Copyright (c) 2018 Markku Linnoskivi
+ *
+ * See the file LICENSE for copying permission.
+ */
+#include "litestorecpp/litestore_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace lscpp
+{
+LitestorePool::Lease::Lease(LitestorePool* pool, Litestore store) noexcept
+    : m_pool(pool),
+      m_store(std::move(store))
+{}
+
+LitestorePool::Lease::Lease(Lease&& other) noexcept
+    : m_pool(std::exchange(other.m_pool, nullptr)),
+      m_store(std::move(other.m_store))
+{}
+
+LitestorePool::Lease& LitestorePool::Lease::operator=(Lease&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        m_pool = std::exchange(other.m_pool, nullptr);
+        m_store = std::move(other.m_store);
+    }
+    return *this;
+}
+
+LitestorePool::Lease::~Lease()
+{
+    release();
+}
+
+void LitestorePool::Lease::release() noexcept
+{
+    if (m_pool)
+    {
+        std::exchange(m_pool, nullptr)->release(std::move(m_store));
+    }
+}
+
+
+LitestorePool::LitestorePool(std::string filename,
+                             const std::size_t minSize,
+                             const std::size_t maxSize,
+                             Litestore::ErrorFunc errFunc)
+    : m_filename(std::move(filename)),
+      m_minSize(minSize),
+      m_maxSize(std::max<std::size_t>({maxSize, minSize, 1})),
+      m_errFunc(std::move(errFunc))
+{
+    m_idle.reserve(m_maxSize);
+    for (std::size_t i = 0; i < m_minSize; ++i)
+    {
+        m_idle.push_back(open());
+        ++m_size;
+    }
+}
+
+LitestorePool::Lease LitestorePool::acquire()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_returned.wait(lock, [this]
+    {
+        return !m_idle.empty() || m_size < m_maxSize;
+    });
+
+    return lease(lock);
+}
+
+LitestorePool::Lease LitestorePool::tryAcquire()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_idle.empty() && m_size == m_maxSize)
+    {
+        return Lease();
+    }
+    return lease(lock);
+}
+
+std::size_t LitestorePool::shrink()
+{
+    std::vector<Litestore> closed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        while (!m_idle.empty() && m_size > m_minSize)
+        {
+            closed.push_back(std::move(m_idle.back()));
+            m_idle.pop_back();
+            --m_size;
+        }
+    }
+    // the handles are closed outside of the lock
+    return closed.size();
+}
+
+std::size_t LitestorePool::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_size;
+}
+
+std::size_t LitestorePool::idle() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_idle.size();
+}
+
+LitestorePool::Lease LitestorePool::lease(std::unique_lock<std::mutex>& lock)
+{
+    if (!m_idle.empty())
+    {
+        Lease lease(this, std::move(m_idle.back()));
+        m_idle.pop_back();
+        return lease;
+    }
+    // reserve the slot and open the handle without holding the lock
+    ++m_size;
+    lock.unlock();
+    try
+    {
+        return Lease(this, open());
+    }
+    catch (...)
+    {
+        lock.lock();
+        --m_size;
+        lock.unlock();
+        m_returned.notify_one();
+        throw;
+    }
+}
+
+Litestore LitestorePool::open()
+{
+    return Litestore(m_filename.c_str(), m_errFunc);
+}
+
+void LitestorePool::release(Litestore store) noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (store.is_open())
+        {
+            m_idle.push_back(std::move(store));
+        }
+        else
+        {
+            // a handle closed by its user is not reused
+            --m_size;
+        }
+    }
+    m_returned.notify_one();
+}
+
+}  // namespace lscpp
@@ -4,10 +4,22 @@
  * See the file LICENSE for copying permission.
  */
 #include "litestorecpp/litestorecpp.hpp"
+#include "litestorecpp/bloom_filter.hpp"
+#include "litestorecpp/hot_keys.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstring>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include <sqlite3.h>
 
 #define UNUSED(x) (void)(x)
 
@@ -19,19 +31,100 @@ void error_trampoline(const int error,
                       const char* desc,
                       void* user_data)
 {
-    auto func = reinterpret_cast<Litestore::ErrorFunc*>(user_data);
-    if (*func)
+    auto ctx = reinterpret_cast<detail::Context*>(user_data);
+    if (ctx->errorFunc && !ctx->muteErrors)
     {
-        (*func)(error, desc);
+        ctx->errorFunc(error, desc);
     }
 }
 
-int read_cb(litestore_blob_t value, void* user_data)
+/**
+ * Return value for callbacks that stop an iteration on purpose,
+ * the resulting error is not reported to the error function.
+ */
+inline
+int stopIteration(detail::Context& ctx)
+{
+    ctx.muteErrors = true;
+    return LITESTORE_ERR;
+}
+
+/**
+ * Clears the muted state when a call returns.
+ */
+class MuteGuard
+{
+public:
+    explicit MuteGuard(detail::Context& ctx)
+        : m_ctx(ctx)
+    {}
+    ~MuteGuard()
+    {
+        m_ctx.muteErrors = false;
+    }
+
+private:
+    detail::Context& m_ctx;
+};
+
+struct ViewContext
+{
+    detail::Context& owner;
+    const Litestore::ViewFunc& func;
+    std::exception_ptr error;
+    bool visited;
+};
+
+int read_view_cb(litestore_blob_t value, void* user_data)
 {
-    std::memcpy(user_data, value.data, value.size);
+    auto ctx = reinterpret_cast<ViewContext*>(user_data);
+    ctx->visited = true;
+    try
+    {
+        ctx->func(BlobView(value.data, value.size));
+
+        return LITESTORE_OK;
+    }
+    catch (...)
+    {
+        ctx->error = std::current_exception();
+    }
+    return stopIteration(ctx->owner);
+}
+
+struct IntoContext
+{
+    void* buffer;
+    std::size_t capacity;
+    std::size_t size;
+};
+
+int read_into_cb(litestore_blob_t value, void* user_data)
+{
+    auto ctx = reinterpret_cast<IntoContext*>(user_data);
+    ctx->size = value.size;
+    if (value.size > 0 && value.size <= ctx->capacity)
+    {
+        std::memcpy(ctx->buffer, value.data, value.size);
+    }
     return LITESTORE_OK;
 }
 
+int read_many_cb(litestore_blob_t value, void* user_data)
+{
+    try
+    {
+        auto arena = reinterpret_cast<std::vector<char>*>(user_data);
+        const auto begin = reinterpret_cast<const char*>(value.data);
+        arena->insert(arena->end(), begin, begin + value.size);
+
+        return LITESTORE_OK;
+    }
+    catch (...)
+    {}
+    return LITESTORE_ERR;
+}
+
 int read_keys_cb(litestore_slice_t key,
                  int object_type,
                  void* user_data)
@@ -51,6 +144,142 @@ int read_keys_cb(litestore_slice_t key,
     return LITESTORE_ERR;
 }
 
+int count_keys_cb(litestore_slice_t key,
+                  int object_type,
+                  void* user_data)
+{
+    UNUSED(key);
+    UNUSED(object_type);
+
+    ++*reinterpret_cast<std::size_t*>(user_data);
+    return LITESTORE_OK;
+}
+
+int read_keys_arena_cb(litestore_slice_t key,
+                       int object_type,
+                       void* user_data)
+{
+    UNUSED(object_type);
+
+    try
+    {
+        auto arena = reinterpret_cast<KeyArena*>(user_data);
+        arena->add(KeyView(key.data, key.length));
+
+        return LITESTORE_OK;
+    }
+    catch (...)
+    {}
+    return LITESTORE_ERR;
+}
+
+struct KeysContext
+{
+    detail::Context& owner;
+    const Litestore::KeyFunc& func;
+    std::exception_ptr error;
+    bool stopped;
+};
+
+int read_keys_func_cb(litestore_slice_t key,
+                      int object_type,
+                      void* user_data)
+{
+    UNUSED(object_type);
+
+    auto ctx = reinterpret_cast<KeysContext*>(user_data);
+    try
+    {
+        if (ctx->func(KeyView(key.data, key.length)))
+        {
+            return LITESTORE_OK;
+        }
+        ctx->stopped = true;
+    }
+    catch (...)
+    {
+        ctx->error = std::current_exception();
+    }
+    return stopIteration(ctx->owner);
+}
+
+struct EntryContext
+{
+    litestore* ls;
+    detail::Context& owner;
+    const Litestore::EntryFunc& func;
+    std::exception_ptr error;
+    bool stopped;
+    // state of the current entry
+    KeyView key;
+    bool visited;
+    bool proceed;
+};
+
+int read_entry_value_cb(litestore_blob_t value, void* user_data)
+{
+    auto ctx = reinterpret_cast<EntryContext*>(user_data);
+    ctx->visited = true;
+    try
+    {
+        ctx->proceed = ctx->func(ctx->key, BlobView(value.data, value.size));
+
+        return LITESTORE_OK;
+    }
+    catch (...)
+    {
+        ctx->error = std::current_exception();
+    }
+    return stopIteration(ctx->owner);
+}
+
+int read_entry_cb(litestore_slice_t key,
+                  int object_type,
+                  void* user_data)
+{
+    UNUSED(object_type);
+
+    auto ctx = reinterpret_cast<EntryContext*>(user_data);
+    ctx->key = KeyView(key.data, key.length);
+    ctx->visited = false;
+    ctx->proceed = true;
+
+    // a null value fails the blob read, that is retried below
+    ctx->owner.muteErrors = true;
+    auto rc = litestore_read(ctx->ls, key, &read_entry_value_cb, ctx);
+    ctx->owner.muteErrors = false;
+    if (ctx->error)
+    {
+        return stopIteration(ctx->owner);
+    }
+    if (!ctx->visited)
+    {
+        rc = litestore_read_null(ctx->ls, key);
+        if (rc == LITESTORE_OK)
+        {
+            try
+            {
+                ctx->proceed = ctx->func(ctx->key, BlobView());
+            }
+            catch (...)
+            {
+                ctx->error = std::current_exception();
+                return stopIteration(ctx->owner);
+            }
+        }
+    }
+    if (rc != LITESTORE_OK)
+    {
+        return LITESTORE_ERR;
+    }
+    if (!ctx->proceed)
+    {
+        ctx->stopped = true;
+        return stopIteration(ctx->owner);
+    }
+    return LITESTORE_OK;
+}
+
 inline
 void throwOnError(const int rc)
 {
@@ -69,35 +298,515 @@ void throwIfClosed(const Litestore& ls)
     }
 }
 
-inline
-litestore_slice_t slice(const std::string& str)
+/**
+ * Escape the GLOB special characters of str,
+ * so that it only matches itself.
+ */
+std::string globEscape(const KeyView str)
+{
+    std::string result;
+    result.reserve(str.size());
+    for (const char c : str)
+    {
+        if (c == '*' || c == '?' || c == '[')
+        {
+            result += '[';
+            result += c;
+            result += ']';
+        }
+        else
+        {
+            result += c;
+        }
+    }
+    return result;
+}
+
+/**
+ * @return Pattern matching keys starting with prefix.
+ *         Literal prefixes let SQLite seek the key index.
+ */
+std::string prefixPattern(const KeyView prefix)
+{
+    return globEscape(prefix) + '*';
+}
+
+/**
+ * Drop a UTF-8 character cut short at the end of str.
+ * GLOB matches whole characters, so patterns are built
+ * from complete ones only.
+ */
+void trimPartialCharacter(std::string& str)
+{
+    auto i = str.size();
+    while (i > 0 && (static_cast<unsigned char>(str[i - 1]) & 0xc0) == 0x80)
+    {
+        --i;
+    }
+    if (i == 0)
+    {
+        return;
+    }
+    const auto lead = static_cast<unsigned char>(str[i - 1]);
+    const std::size_t length = lead >= 0xf0 ? 4
+                             : lead >= 0xe0 ? 3
+                             : lead >= 0xc0 ? 2
+                             : 1;
+    if (str.size() - (i - 1) < length)
+    {
+        str.resize(i - 1);
+    }
+}
+
+/**
+ * Bounds of Litestore::scanRange().
+ */
+struct KeyRange
+{
+    std::string begin;
+    std::string end;
+    std::size_t limit;
+
+    bool contains(const std::string& key) const
+    {
+        return !(key < begin) && (end.empty() || key < end);
+    }
+    /**
+     * @return True if no key starting with prefix is in range
+     *         because they all sort before begin.
+     */
+    bool before(const std::string& prefix) const
+    {
+        return begin.compare(0, prefix.size(), prefix) > 0;
+    }
+    /**
+     * @return True if no key starting with prefix is in range
+     *         because they all sort at or after end.
+     */
+    bool after(const std::string& prefix) const
+    {
+        return !end.empty() && !(prefix < end);
+    }
+};
+
+// keys listed at once by scanRange(), larger buckets are split
+const std::size_t SCAN_BUCKET = 256;
+
+/**
+ * Append the keys that are in range in ascending order,
+ * while results has room for them.
+ */
+void appendRange(std::vector<std::string>& keys,
+                 const KeyRange& range,
+                 std::vector<std::string>& results)
+{
+    keys.erase(std::remove_if(keys.begin(), keys.end(),
+                              [&](const std::string& key)
+                              {
+                                  return !range.contains(key);
+                              }),
+               keys.end());
+    std::sort(keys.begin(), keys.end());
+    for (auto& key : keys)
+    {
+        if (range.limit != 0 && results.size() == range.limit)
+        {
+            break;
+        }
+        results.push_back(std::move(key));
+    }
+}
+
+void collectRange(Litestore& ls,
+                  const std::string& pattern,
+                  const KeyRange& range,
+                  std::vector<std::string>& results)
+{
+    auto keys = ls.keys(pattern);
+    appendRange(keys, range, results);
+}
+
+/**
+ * Append the keys in range that start with prefix and are longer
+ * than it, in ascending order, until results is at the limit.
+ *
+ * The keys are visited in buckets by the byte following the prefix,
+ * smallest first, so that the scan stops early. GLOB matches whole
+ * UTF-8 characters, so the keys continuing with a non-ASCII byte
+ * form a single last bucket. Keys with NUL bytes are not supported.
+ */
+void scanBuckets(Litestore& ls,
+                 const std::string& prefix,
+                 const KeyRange& range,
+                 std::vector<std::string>& results)
+{
+    for (int c = 1; c < 0x80 && results.size() < range.limit; ++c)
+    {
+        const auto bucket = prefix + static_cast<char>(c);
+        if (range.before(bucket))
+        {
+            continue;
+        }
+        if (range.after(bucket))
+        {
+            return;
+        }
+        std::vector<std::string> keys;
+        ls.keys(prefixPattern(bucket), [&](KeyView key)
+        {
+            keys.push_back(key.str());
+            return keys.size() <= SCAN_BUCKET;
+        });
+        if (keys.size() <= SCAN_BUCKET)
+        {
+            appendRange(keys, range, results);
+            continue;
+        }
+        if (range.contains(bucket) && ls.exists(bucket))
+        {
+            results.push_back(bucket);
+        }
+        scanBuckets(ls, bucket, range, results);
+    }
+    if (results.size() < range.limit && !range.after(prefix + '\x80'))
+    {
+        collectRange(ls, globEscape(prefix) + "[^\x01-\x7f]*", range, results);
+    }
+}
+
+/**
+ * @return False if key definitely does not exist.
+ */
+inline
+bool mayExist(const detail::Context& ctx, const KeyView key)
+{
+    return !ctx.keyFilter || ctx.keyFilter->mayContain(key);
+}
+
+inline
+void keyWritten(detail::Context& ctx, const KeyView key)
+{
+    if (ctx.keyFilter)
+    {
+        ctx.keyFilter->add(key);
+    }
+}
+
+/**
+ * Called on reads, updates and deletes of a single key.
+ */
+inline
+void keyAccessed(detail::Context& ctx, const KeyView key)
+{
+    if (ctx.hotKeys)
+    {
+        ctx.hotKeys->record(key);
+    }
+}
+
+/**
+ * Called on writes that may change the set of keys.
+ */
+inline
+void keysChanged(detail::Context& ctx)
+{
+    ++ctx.generation;
+}
+
+/**
+ * @return Memoized keys for pattern or nullptr.
+ */
+Litestore::SharedKeys cachedKeys(const detail::Context& ctx,
+                                 const KeyView pattern)
+{
+    if (ctx.keysCacheCapacity == 0)
+    {
+        return nullptr;
+    }
+    const auto it = ctx.keysCache.find(pattern.str());
+    if (it == ctx.keysCache.end() || it->second.generation != ctx.generation)
+    {
+        return nullptr;
+    }
+    return it->second.keys;
+}
+
+void cacheKeys(detail::Context& ctx,
+               const KeyView pattern,
+               Litestore::SharedKeys keys)
+{
+    if (ctx.keysCacheCapacity == 0)
+    {
+        return;
+    }
+    auto& cache = ctx.keysCache;
+    if (cache.size() >= ctx.keysCacheCapacity && !cache.count(pattern.str()))
+    {
+        for (auto it = cache.begin(); it != cache.end();)
+        {
+            it = it->second.generation != ctx.generation ?
+                cache.erase(it) : std::next(it);
+        }
+        if (cache.size() >= ctx.keysCacheCapacity)
+        {
+            cache.erase(cache.begin());
+        }
+    }
+    cache[pattern.str()] =
+        detail::Context::KeysEntry{ctx.generation, std::move(keys)};
+}
+
+inline
+litestore_slice_t slice(const KeyView str)
+{
+    return litestore_slice(str.data(), 0, str.size());
+}
+
+int createBlob(litestore* ls, litestore_slice_t key, litestore_blob_t blob)
+{
+    return !blob.data ?
+        litestore_create_null(ls, key)
+        : litestore_create(ls, key, blob);
+}
+
+int updateBlob(litestore* ls, litestore_slice_t key, litestore_blob_t blob)
+{
+    return !blob.data ?
+        litestore_update_null(ls, key)
+        : litestore_update(ls, key, blob);
+}
+
+int deleteKey(litestore* ls, litestore_slice_t key)
+{
+    // can return UNKNOWN_ENTITY, not error
+    const auto rc = litestore_delete(ls, key);
+    return rc == LITESTORE_UNKNOWN_ENTITY ? LITESTORE_OK : rc;
+}
+
+void runHooks(std::vector<Transaction::Hook>& hooks) noexcept
+{
+    for (auto& hook : hooks)
+    {
+        try
+        {
+            hook();
+        }
+        catch (...)
+        {}
+    }
+    hooks.clear();
+}
+
+std::unique_ptr<detail::Context> createContext(const char* filename,
+                                              Litestore::ErrorFunc errFunc)
+{
+    std::unique_ptr<detail::Context> ctx(new detail::Context);
+    ctx->errorFunc = std::move(errFunc);
+    ctx->filename = filename ? filename : "";
+
+    return ctx;
+}
+
+std::size_t countKeys(litestore* ls, const KeyView pattern)
+{
+    std::size_t n = 0;
+    throwOnError(
+        litestore_read_keys(ls,
+                            slice(pattern),
+                            &count_keys_cb,
+                            &n)
+    );
+
+    return n;
+}
+
+detail::Handle createHandle(const char* filename, const litestore_opts& opts)
+{
+    litestore* ptr = nullptr;
+    const auto rc = litestore_open(filename, opts, &ptr);
+    if (rc != LITESTORE_OK)
+    {
+        throw std::runtime_error("Failed to open litestore!");
+    }
+    
+    return detail::Handle(ptr);
+}
+
+/**
+ * Keys visited by parallelForEach() as a unit: those starting
+ * with prefix, or those continuing it with a non-ASCII character.
+ */
+struct KeyBucket
+{
+    std::string prefix;
+    bool nonAscii;
+
+    std::string pattern() const
+    {
+        return nonAscii ? globEscape(prefix) + "[^\x01-\x7f]*"
+                        : prefixPattern(prefix);
+    }
+};
+
+/**
+ * Buckets of a parallelForEach() worker. The owner takes from
+ * the back, thieves take the older, larger ones from the front.
+ */
+struct WorkQueue
+{
+    std::mutex mutex;
+    std::deque<KeyBucket> buckets;
+};
+
+/**
+ * List the keys of bucket that match pattern.
+ *
+ * A bucket with more than SCAN_BUCKET keys is split by the byte
+ * following the prefix instead, only the prefix itself is listed
+ * then, whether or not it exists. GLOB matches whole UTF-8
+ * characters, so the non-ASCII bucket is never split.
+ *
+ * @return The sub buckets, empty if every key was listed.
+ */
+std::vector<KeyBucket> listBucket(Litestore& ls,
+                                  const std::string& pattern,
+                                  const KeyBucket& bucket,
+                                  std::vector<std::string>& keys)
+{
+    ls.keys(bucket.pattern(), [&](KeyView key)
+    {
+        keys.push_back(key.str());
+        return bucket.nonAscii || keys.size() <= SCAN_BUCKET;
+    });
+    const auto matches = [&pattern](const std::string& key)
+    {
+        return sqlite3_strglob(pattern.c_str(), key.c_str()) == 0;
+    };
+
+    std::vector<KeyBucket> split;
+    if (keys.size() > SCAN_BUCKET && !bucket.nonAscii)
+    {
+        keys.clear();
+        if (matches(bucket.prefix))
+        {
+            keys.push_back(bucket.prefix);
+        }
+        for (int c = 1; c < 0x80; ++c)
+        {
+            split.push_back(KeyBucket{bucket.prefix + static_cast<char>(c), false});
+        }
+        split.push_back(KeyBucket{bucket.prefix, true});
+
+        return split;
+    }
+    keys.erase(std::remove_if(keys.begin(), keys.end(),
+                              [&](const std::string& key)
+                              {
+                                  return !matches(key);
+                              }),
+               keys.end());
+    return split;
+}
+
+/**
+ * Take a bucket from queues[self], or steal one from another queue.
+ *
+ * @return False if every queue is empty.
+ */
+bool takeBucket(std::vector<std::unique_ptr<WorkQueue>>& queues,
+                const std::size_t self,
+                KeyBucket& bucket)
+{
+    for (std::size_t k = 0; k < queues.size(); ++k)
+    {
+        const auto i = (self + k) % queues.size();
+        auto& queue = *queues[i];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.buckets.empty())
+        {
+            continue;
+        }
+        if (i == self)
+        {
+            bucket = std::move(queue.buckets.back());
+            queue.buckets.pop_back();
+        }
+        else
+        {
+            bucket = std::move(queue.buckets.front());
+            queue.buckets.pop_front();
+        }
+        return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+bool detail::isPrivateDatabase(const std::string& filename)
 {
-    return litestore_slice(str.c_str(), 0, str.length());
+    return filename.empty()
+        || filename == ":memory:"
+        || filename.find("mode=memory") != std::string::npos;
 }
 
-detail::Handle createHandle(const char* filename, const litestore_opts& opts)
+void detail::runWorkers(const std::size_t n, const WorkerFunc& work)
 {
-    litestore* ptr = nullptr;
-    const auto rc = litestore_open(filename, opts, &ptr);
-    if (rc != LITESTORE_OK)
+    std::atomic<bool> stop(false);
+    if (n <= 1)
     {
-        throw std::runtime_error("Failed to open litestore!");
+        if (n == 1)
+        {
+            work(0, stop);
+        }
+        return;
     }
-    
-    return detail::Handle(ptr);
-}
 
-}  // namespace
+    std::mutex mutex;
+    std::exception_ptr error;
+    std::vector<std::thread> threads;
+    threads.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        threads.emplace_back([&, i]
+        {
+            try
+            {
+                work(i, stop);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+                stop = true;
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
 
-Transaction::Transaction(litestore* ls)
-    : m_litestore(ls)
+Transaction::Transaction(litestore* ls, detail::Context* ctx)
+    : m_litestore(ls),
+      m_context(ctx)
 {
     assert(ls);
+    assert(ctx);
 
     throwOnError(
         litestore_begin_tx(m_litestore)
     );
     m_state = State::OPEN;
+    m_context->inTx = true;
 }
 
 Transaction::~Transaction() noexcept
@@ -107,13 +816,18 @@ Transaction::~Transaction() noexcept
         if (m_state == State::OPEN)
         {
             litestore_rollback_tx(m_litestore);
+            rolledBack();
         }
     }
 }
 
 Transaction::Transaction(Transaction&& rhs) noexcept
     : m_litestore(std::exchange(rhs.m_litestore, nullptr)),
-      m_state(std::exchange(rhs.m_state, State::INITIAL))
+      m_context(std::exchange(rhs.m_context, nullptr)),
+      m_state(std::exchange(rhs.m_state, State::INITIAL)),
+      m_rollbackHooks(std::move(rhs.m_rollbackHooks)),
+      m_commitHooks(std::move(rhs.m_commitHooks)),
+      m_beforeCommitHooks(std::move(rhs.m_beforeCommitHooks))
 {}
 
 void Transaction::commit()
@@ -122,10 +836,15 @@ void Transaction::commit()
     {
         if (m_state == State::OPEN)
         {
+            for (auto& hook : m_beforeCommitHooks)
+            {
+                hook();
+            }
             throwOnError(
                 litestore_commit_tx(m_litestore)
             );
             m_state = State::DONE;
+            committed();
         }
     }
     else
@@ -144,6 +863,7 @@ void Transaction::rollback()
                 litestore_rollback_tx(m_litestore)
             );
             m_state = State::DONE;
+            rolledBack();
         }
     }
     else
@@ -152,14 +872,46 @@ void Transaction::rollback()
     }
 }
 
+void Transaction::onRollback(Hook hook)
+{
+    m_rollbackHooks.push_back(std::move(hook));
+}
+
+void Transaction::onCommit(Hook hook)
+{
+    m_commitHooks.push_back(std::move(hook));
+}
+
+void Transaction::beforeCommit(Hook hook)
+{
+    m_beforeCommitHooks.push_back(std::move(hook));
+}
+
+void Transaction::rolledBack() noexcept
+{
+    m_context->inTx = false;
+    keysChanged(*m_context);
+    m_beforeCommitHooks.clear();
+    runHooks(m_rollbackHooks);
+    m_commitHooks.clear();
+}
+
+void Transaction::committed() noexcept
+{
+    m_context->inTx = false;
+    m_beforeCommitHooks.clear();
+    runHooks(m_commitHooks);
+    m_rollbackHooks.clear();
+}
+
 
 Litestore::Litestore(const char* filename)
     : Litestore(filename, ErrorFunc{})
 {}
 
 Litestore::Litestore(const char* filename, ErrorFunc errFunc)
-    : m_errorFunc(std::move(errFunc)),
-      m_litestore(createHandle(filename, { &error_trampoline, &m_errorFunc }))
+    : m_context(createContext(filename, std::move(errFunc))),
+      m_litestore(createHandle(filename, { &error_trampoline, m_context.get() }))
 {}
 
 bool Litestore::is_open() const noexcept
@@ -167,6 +919,91 @@ bool Litestore::is_open() const noexcept
     return (m_litestore != nullptr);
 }
 
+std::string Litestore::filename() const
+{
+    return m_context ? m_context->filename : std::string();
+}
+
+void Litestore::enableKeyFilter(const std::size_t expectedKeys,
+                                const double falsePositiveRate)
+{
+    throwIfClosed(*this);
+
+    m_context->keyFilter.reset();
+    std::unique_ptr<BloomFilter> filter(
+        new BloomFilter(std::max(expectedKeys, count("*")),
+                        falsePositiveRate));
+    keys("*", [&](KeyView key)
+    {
+        filter->add(key);
+        return true;
+    });
+    m_context->keyFilter = std::move(filter);
+}
+
+void Litestore::disableKeyFilter() noexcept
+{
+    if (m_context)
+    {
+        m_context->keyFilter.reset();
+    }
+}
+
+void Litestore::enableKeysCache(const std::size_t maxPatterns)
+{
+    throwIfClosed(*this);
+
+    m_context->keysCache.clear();
+    m_context->keysCacheCapacity = maxPatterns;
+}
+
+void Litestore::disableKeysCache() noexcept
+{
+    if (m_context)
+    {
+        m_context->keysCache.clear();
+        m_context->keysCacheCapacity = 0;
+    }
+}
+
+void Litestore::enableHotKeyTracking(const std::size_t sampleEvery,
+                                     const std::size_t capacity)
+{
+    throwIfClosed(*this);
+
+    m_context->hotKeys.reset(new HotKeyTracker(sampleEvery, capacity));
+}
+
+void Litestore::disableHotKeyTracking() noexcept
+{
+    if (m_context)
+    {
+        m_context->hotKeys.reset();
+    }
+}
+
+std::vector<HotKey> Litestore::hotKeys(const std::size_t k) const
+{
+    if (!m_context || !m_context->hotKeys)
+    {
+        return {};
+    }
+    return m_context->hotKeys->top(k);
+}
+
+void Litestore::recordAccess(const KeyView key)
+{
+    if (m_context)
+    {
+        keyAccessed(*m_context, key);
+    }
+}
+
+bool Litestore::inTx() const noexcept
+{
+    return m_context && m_context->inTx;
+}
+
 void Litestore::close() noexcept
 {
     m_litestore.reset();
@@ -174,26 +1011,210 @@ void Litestore::close() noexcept
 
 Transaction Litestore::createTx()
 {
-    return Transaction{m_litestore.get()};
+    throwIfClosed(*this);
+
+    return Transaction{m_litestore.get(), m_context.get()};
+}
+
+template <typename Func>
+void Litestore::runInTx(Func&& func)
+{
+    if (m_context->inTx)
+    {
+        func();
+        return;
+    }
+    auto tx = createTx();
+    func();
+    tx.commit();
 }
 
 /** CRUD API */
-void Litestore::del(const std::string& key)
+void Litestore::readView(const KeyView key, const ViewFunc& func)
 {
     throwIfClosed(*this);
 
-    // can return UNKNOWN_ENTITY, not error
-    const auto rc = litestore_delete(m_litestore.get(), slice(key));
-    if (rc == LITESTORE_ERR)
+    keyAccessed(*m_context, key);
+    if (!mayExist(*m_context, key))
     {
-        throwOnError(rc);
+        throwOnError(LITESTORE_UNKNOWN_ENTITY);
+    }
+    MuteGuard guard(*m_context);
+    ViewContext ctx{*m_context, func, nullptr, false};
+    const auto rc = litestore_read(m_litestore.get(),
+                                   slice(key),
+                                   &read_view_cb,
+                                   &ctx);
+    if (ctx.error)
+    {
+        std::rethrow_exception(ctx.error);
+    }
+    throwOnError(rc);
+}
+
+bool Litestore::tryReadView(const KeyView key, const ViewFunc& func)
+{
+    throwIfClosed(*this);
+
+    keyAccessed(*m_context, key);
+    if (!mayExist(*m_context, key))
+    {
+        return false;
+    }
+    ViewContext ctx{*m_context, func, nullptr, false};
+    int rc = LITESTORE_OK;
+    {
+        // a null value fails the blob read, that is retried below
+        MuteGuard guard(*m_context);
+        m_context->muteErrors = true;
+        rc = litestore_read(m_litestore.get(), slice(key), &read_view_cb, &ctx);
+    }
+    if (ctx.error)
+    {
+        std::rethrow_exception(ctx.error);
+    }
+    if (!ctx.visited && rc != LITESTORE_UNKNOWN_ENTITY)
+    {
+        rc = litestore_read_null(m_litestore.get(), slice(key));
+    }
+    if (rc == LITESTORE_UNKNOWN_ENTITY)
+    {
+        return false;
+    }
+    throwOnError(rc);
+
+    return ctx.visited;
+}
+
+std::size_t Litestore::readInto(const KeyView key,
+                                void* buffer,
+                                const std::size_t capacity)
+{
+    IntoContext ctx{buffer, capacity, 0};
+    readImpl(key, &read_into_cb, &ctx);
+
+    return ctx.size;
+}
+
+MultiRead Litestore::readMany(const std::vector<KeyView>& keys)
+{
+    MultiRead result;
+    readMany(keys, result);
+
+    return result;
+}
+
+void Litestore::readMany(const std::vector<KeyView>& keys,
+                         MultiRead& result)
+{
+    throwIfClosed(*this);
+
+    result.clear();
+    result.m_entries.reserve(keys.size());
+    runInTx([&]
+    {
+        for (const auto& key : keys)
+        {
+            keyAccessed(*m_context, key);
+            const auto offset = result.m_arena.size();
+            if (!mayExist(*m_context, key))
+            {
+                result.m_entries.push_back({offset, 0, false, false});
+                continue;
+            }
+            int rc = LITESTORE_OK;
+            {
+                // a null value fails the blob read, that is retried below
+                MuteGuard guard(*m_context);
+                m_context->muteErrors = true;
+                rc = litestore_read(m_litestore.get(),
+                                    slice(key),
+                                    &read_many_cb,
+                                    &result.m_arena);
+            }
+            bool null = false;
+            if (rc == LITESTORE_ERR)
+            {
+                result.m_arena.resize(offset);
+                rc = litestore_read_null(m_litestore.get(), slice(key));
+                null = rc == LITESTORE_OK;
+            }
+            if (rc != LITESTORE_UNKNOWN_ENTITY)
+            {
+                throwOnError(rc);
+            }
+            result.m_entries.push_back({offset,
+                                        result.m_arena.size() - offset,
+                                        rc == LITESTORE_OK,
+                                        null});
+        }
+    });
+}
+
+void Litestore::del(const KeyView key)
+{
+    throwIfClosed(*this);
+
+    keyAccessed(*m_context, key);
+    throwOnError(
+        deleteKey(m_litestore.get(), slice(key))
+    );
+    keysChanged(*m_context);
+}
+
+bool Litestore::exists(const KeyView key)
+{
+    throwIfClosed(*this);
+
+    if (!mayExist(*m_context, key))
+    {
+        return false;
     }
+    // an escaped key is an exact match that SQLite answers from the index
+    return countKeys(m_litestore.get(), globEscape(key)) > 0;
+}
+
+void Litestore::write(const WriteBatch& batch)
+{
+    throwIfClosed(*this);
+
+    keysChanged(*m_context);
+    runInTx([&]
+    {
+        litestore* ls = m_litestore.get();
+        // an empty arena has no storage, empty slices still need a pointer
+        const char* arena = batch.m_arena.empty() ? "" : batch.m_arena.data();
+        for (const auto& e : batch.m_entries)
+        {
+            const auto key = litestore_slice(arena + e.keyOffset, 0, e.keyLength);
+            const auto value = litestore_make_blob(
+                e.null ? nullptr : arena + e.valueOffset, e.valueSize);
+            switch (e.op)
+            {
+                case WriteBatch::Op::CREATE:
+                    throwOnError(createBlob(ls, key, value));
+                    keyWritten(*m_context, KeyView(key.data, key.length));
+                    break;
+                case WriteBatch::Op::UPDATE:
+                    throwOnError(updateBlob(ls, key, value));
+                    keyWritten(*m_context, KeyView(key.data, key.length));
+                    break;
+                case WriteBatch::Op::DEL:
+                    throwOnError(deleteKey(ls, key));
+                    break;
+            }
+        }
+    });
 }
 
-std::vector<std::string> Litestore::keys(const std::string& pattern)
+std::vector<std::string> Litestore::keys(const KeyView pattern)
 {
     throwIfClosed(*this);
 
+    if (const auto cached = cachedKeys(*m_context, pattern))
+    {
+        return *cached;
+    }
     std::vector<std::string> results;
     throwOnError(
         litestore_read_keys(m_litestore.get(),
@@ -201,50 +1222,294 @@ std::vector<std::string> Litestore::keys(const std::string& pattern)
                             &read_keys_cb,
                             &results)
     );
+    if (m_context->keysCacheCapacity != 0)
+    {
+        cacheKeys(*m_context,
+                  pattern,
+                  std::make_shared<const std::vector<std::string>>(results));
+    }
+    return results;
+}
+
+Litestore::SharedKeys Litestore::sharedKeys(const KeyView pattern)
+{
+    throwIfClosed(*this);
+
+    if (auto cached = cachedKeys(*m_context, pattern))
+    {
+        return cached;
+    }
+    auto results = std::make_shared<std::vector<std::string>>();
+    throwOnError(
+        litestore_read_keys(m_litestore.get(),
+                            slice(pattern),
+                            &read_keys_cb,
+                            results.get())
+    );
+    SharedKeys shared(std::move(results));
+    cacheKeys(*m_context, pattern, shared);
+
+    return shared;
+}
+
+void Litestore::keys(const KeyView pattern, const KeyFunc& func)
+{
+    throwIfClosed(*this);
+
+    MuteGuard guard(*m_context);
+    KeysContext ctx{*m_context, func, nullptr, false};
+    const auto rc = litestore_read_keys(m_litestore.get(),
+                                        slice(pattern),
+                                        &read_keys_func_cb,
+                                        &ctx);
+    if (ctx.error)
+    {
+        std::rethrow_exception(ctx.error);
+    }
+    if (!ctx.stopped)
+    {
+        throwOnError(rc);
+    }
+}
+
+void Litestore::keys(const KeyView pattern, KeyArena& arena)
+{
+    throwIfClosed(*this);
+
+    arena.clear();
+    throwOnError(
+        litestore_read_keys(m_litestore.get(),
+                            slice(pattern),
+                            &read_keys_arena_cb,
+                            &arena)
+    );
+}
+
+void Litestore::forEach(const KeyView pattern, const EntryFunc& func)
+{
+    throwIfClosed(*this);
+
+    runInTx([&]
+    {
+        MuteGuard guard(*m_context);
+        EntryContext ctx{m_litestore.get(), *m_context, func, nullptr, false,
+                         KeyView(), false, true};
+        const auto rc = litestore_read_keys(m_litestore.get(),
+                                            slice(pattern),
+                                            &read_entry_cb,
+                                            &ctx);
+        if (ctx.error)
+        {
+            std::rethrow_exception(ctx.error);
+        }
+        if (!ctx.stopped)
+        {
+            throwOnError(rc);
+        }
+    });
+}
+
+void Litestore::parallelForEach(const KeyView pattern,
+                                const ParallelEntryFunc& func,
+                                const std::size_t threads)
+{
+    const auto glob = pattern.str();
+    const auto visit = [&func](Litestore& store,
+                               const std::vector<std::string>& keys)
+    {
+        for (const auto& key : keys)
+        {
+            store.tryReadView(key, [&](BlobView value)
+            {
+                func(key, value);
+            });
+        }
+    };
+
+    // small key sets are visited by the calling thread alone
+    std::vector<std::string> keys;
+    const KeyBucket root{glob.substr(0, glob.find_first_of("*?[")), false};
+    auto buckets = listBucket(*this, glob, root, keys);
+    visit(*this, keys);
+    if (buckets.empty())
+    {
+        return;
+    }
+
+    const auto filename = m_context->filename;
+    const auto shared = detail::isPrivateDatabase(filename) || m_context->inTx;
+    const std::size_t n = shared ? 1
+        : threads ? threads
+                  : std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        queues.emplace_back(new WorkQueue);
+    }
+    for (std::size_t i = 0; i < buckets.size(); ++i)
+    {
+        queues[i % n]->buckets.push_back(std::move(buckets[i]));
+    }
+    // buckets queued or being visited, visiting may split one
+    std::atomic<std::size_t> pending(buckets.size());
+
+    detail::runWorkers(n, [&](const std::size_t self,
+                              const std::atomic<bool>& stop)
+    {
+        std::unique_ptr<Litestore> own;
+        if (!shared)
+        {
+            own.reset(new Litestore(filename.c_str()));
+        }
+        auto& store = own ? *own : *this;
+
+        KeyBucket bucket;
+        while (!stop && pending > 0)
+        {
+            if (!takeBucket(queues, self, bucket))
+            {
+                // others may still split theirs
+                std::this_thread::yield();
+                continue;
+            }
+            std::vector<std::string> keys;
+            auto split = listBucket(store, glob, bucket, keys);
+            visit(store, keys);
+            if (!split.empty())
+            {
+                pending += split.size();
+                auto& queue = *queues[self];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                std::move(split.begin(), split.end(),
+                          std::back_inserter(queue.buckets));
+            }
+            --pending;
+        }
+    });
+}
+
+std::size_t Litestore::count(const KeyView pattern)
+{
+    throwIfClosed(*this);
+
+    if (const auto cached = cachedKeys(*m_context, pattern))
+    {
+        return cached->size();
+    }
+    return countKeys(m_litestore.get(), pattern);
+}
+
+std::vector<std::string> Litestore::scanPrefix(const KeyView prefix)
+{
+    auto results = keys(prefixPattern(prefix));
+    std::sort(results.begin(), results.end());
+
+    return results;
+}
+
+std::vector<std::string> Litestore::scanRange(const KeyView begin,
+                                              const KeyView end,
+                                              const std::size_t limit)
+{
+    throwIfClosed(*this);
+
+    // every key in range shares the common prefix of the bounds
+    std::string prefix;
+    if (!end.empty())
+    {
+        const auto n = std::min(begin.size(), end.size());
+        const auto diff = std::mismatch(begin.begin(), begin.begin() + n,
+                                        end.begin());
+        prefix.assign(begin.begin(), diff.first);
+        trimPartialCharacter(prefix);
+    }
+    const KeyRange range{begin.str(), end.str(), limit};
+
+    std::vector<std::string> results;
+    if (limit == 0)
+    {
+        collectRange(*this, prefixPattern(prefix), range, results);
+        return results;
+    }
+    if (range.contains(prefix) && exists(prefix))
+    {
+        results.push_back(prefix);
+    }
+    scanBuckets(*this, prefix, range, results);
 
     return results;
 }
 
-void Litestore::createImpl(const std::string& key, litestore_blob_t blobIn)
+void Litestore::createImpl(const KeyView key, litestore_blob_t blobIn)
 {
     throwIfClosed(*this);
 
     throwOnError(
-        !blobIn.data ?
-            litestore_create_null(m_litestore.get(), slice(key))
-            : litestore_create(m_litestore.get(), slice(key), blobIn)
+        createBlob(m_litestore.get(), slice(key), blobIn)
     );
+    keyWritten(*m_context, key);
+    keysChanged(*m_context);
 }
 
-void Litestore::readImpl(const std::string& key, void* blobOut)
+void Litestore::readImpl(const KeyView key,
+                         ReadFunc func,
+                         void* userData)
 {
     throwIfClosed(*this);
  
+    keyAccessed(*m_context, key);
+    if (!mayExist(*m_context, key))
+    {
+        throwOnError(LITESTORE_UNKNOWN_ENTITY);
+    }
     throwOnError(
-        !blobOut ?
+        !func ?
             litestore_read_null(m_litestore.get(), slice(key))
             : litestore_read(m_litestore.get(),
                              slice(key),
-                             &read_cb,
-                             blobOut)
+                             func,
+                             userData)
     );
 }
 
-void Litestore::updateImpl(const std::string& key, litestore_blob_t blobIn)
+void Litestore::updateImpl(const KeyView key, litestore_blob_t blobIn)
 {
     throwIfClosed(*this);
 
+    keyAccessed(*m_context, key);
     throwOnError(
-        !blobIn.data ?
-            litestore_update_null(m_litestore.get(), slice(key))
-            : litestore_update(m_litestore.get(), slice(key), blobIn)
+        updateBlob(m_litestore.get(), slice(key), blobIn)
     );
+    keyWritten(*m_context, key);
+    keysChanged(*m_context);
 }
 
+void WriteBatch::del(const KeyView key)
+{
+    add(Op::DEL, key, litestore_make_blob(nullptr, 0));
+}
+
+void WriteBatch::add(const Op op,
+                     const KeyView key,
+                     litestore_blob_t value)
+{
+    const auto keyOffset = m_arena.size();
+    m_arena.insert(m_arena.end(), key.data(), key.data() + key.size());
+    const auto valueOffset = m_arena.size();
+    const auto begin = reinterpret_cast<const char*>(value.data);
+    if (begin)
+    {
+        m_arena.insert(m_arena.end(), begin, begin + value.size);
+    }
+    m_entries.push_back({op, keyOffset, key.size(),
+                         valueOffset, value.size, begin == nullptr});
+}
 
 namespace detail
 {
 
+Context::~Context() = default;
+
 void LSDelete::operator()(litestore* handle) const
 {
     litestore_close(handle);
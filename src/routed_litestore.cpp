@@ -0,0 +1,120 @@
+/**
+ * Copyright (c) 2018 Markku Linnoskivi
+ *
+ * See the file LICENSE for copying permission.
+ */
+#include "litestorecpp/routed_litestore.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <sqlite3.h>
+
+namespace lscpp
+{
+namespace
+{
+/**
+ * liblitestore has no way to set the journal mode,
+ * so it is set on the file directly. The mode persists
+ * in the file and applies to the handles opened later.
+ */
+const std::string& enableWal(const std::string& filename)
+{
+    sqlite3* db = nullptr;
+    auto rc = sqlite3_open_v2(filename.c_str(),
+                              &db,
+                              SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE,
+                              nullptr);
+    bool wal = false;
+    if (rc == SQLITE_OK)
+    {
+        sqlite3_stmt* stmt = nullptr;
+        rc = sqlite3_prepare_v2(db, "PRAGMA journal_mode=WAL", -1, &stmt, nullptr);
+        if (rc == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW)
+        {
+            const auto mode = sqlite3_column_text(stmt, 0);
+            wal = mode && std::strcmp(reinterpret_cast<const char*>(mode),
+                                      "wal") == 0;
+        }
+        sqlite3_finalize(stmt);
+    }
+    sqlite3_close(db);
+    if (!wal)
+    {
+        throw std::runtime_error("Failed to enable WAL on " + filename);
+    }
+    return filename;
+}
+
+}  // namespace
+
+RoutedLitestore::RoutedLitestore(std::string filename,
+                                 const std::size_t readers,
+                                 Litestore::ErrorFunc errFunc)
+    : m_writer(enableWal(filename).c_str(), errFunc),
+      m_readers(std::move(filename), readers, readers, std::move(errFunc))
+{}
+
+RoutedLitestore::Writer RoutedLitestore::writer()
+{
+    return Writer(m_writerMutex, m_writer);
+}
+
+void RoutedLitestore::del(const KeyView key)
+{
+    writer()->del(key);
+}
+
+void RoutedLitestore::write(const WriteBatch& batch)
+{
+    writer()->write(batch);
+}
+
+void RoutedLitestore::readView(const KeyView key,
+                               const Litestore::ViewFunc& func)
+{
+    m_readers.acquire()->readView(key, func);
+}
+
+bool RoutedLitestore::exists(const KeyView key)
+{
+    return m_readers.acquire()->exists(key);
+}
+
+std::vector<std::string> RoutedLitestore::keys(const KeyView pattern)
+{
+    return m_readers.acquire()->keys(pattern);
+}
+
+void RoutedLitestore::keys(const KeyView pattern,
+                           const Litestore::KeyFunc& func)
+{
+    m_readers.acquire()->keys(pattern, func);
+}
+
+std::size_t RoutedLitestore::count(const KeyView pattern)
+{
+    return m_readers.acquire()->count(pattern);
+}
+
+void RoutedLitestore::forEach(const KeyView pattern,
+                              const Litestore::EntryFunc& func)
+{
+    m_readers.acquire()->forEach(pattern, func);
+}
+
+std::vector<std::string> RoutedLitestore::scanPrefix(const KeyView prefix)
+{
+    return m_readers.acquire()->scanPrefix(prefix);
+}
+
+std::vector<std::string> RoutedLitestore::scanRange(const KeyView begin,
+                                                    const KeyView end,
+                                                    const std::size_t limit)
+{
+    return m_readers.acquire()->scanRange(begin, end, limit);
+}
+
+}  // namespace lscpp
@@ -0,0 +1,134 @@
+/**
+ * Copyright (c) 2018 Markku Linnoskivi
+ *
+ * See the file LICENSE for copying permission.
+ */
+#include "litestorecpp/sharded_litestore.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace lscpp
+{
+namespace
+{
+std::vector<std::string> shardFilenames(const std::string& basename,
+                                        const std::size_t shards)
+{
+    std::vector<std::string> filenames;
+    for (std::size_t i = 0; i < std::max<std::size_t>(shards, 1); ++i)
+    {
+        filenames.push_back(basename + "." + std::to_string(i));
+    }
+    return filenames;
+}
+
+}  // namespace
+
+ShardedLitestore::ShardedLitestore(const std::string& basename,
+                                   const std::size_t shards)
+    : ShardedLitestore(shardFilenames(basename, shards))
+{}
+
+ShardedLitestore::ShardedLitestore(const std::vector<std::string>& filenames)
+{
+    if (filenames.empty())
+    {
+        throw std::runtime_error("ShardedLitestore needs at least one shard");
+    }
+    m_shards.reserve(filenames.size());
+    for (const auto& filename : filenames)
+    {
+        m_shards.emplace_back(new Shard(Litestore(filename.c_str())));
+    }
+}
+
+std::size_t ShardedLitestore::shardOf(const KeyView key) const noexcept
+{
+    // mixed so that similar keys spread evenly over few shards
+    const auto h = detail::mixHash(KeyHash()(key));
+
+    return static_cast<std::size_t>(h % m_shards.size());
+}
+
+ShardedLitestore::Lease ShardedLitestore::shard(const std::size_t i)
+{
+    auto& s = *m_shards.at(i);
+
+    return Lease(s.mutex, s.store);
+}
+
+void ShardedLitestore::forEachShard(const ShardFunc& func)
+{
+    std::vector<std::exception_ptr> errors(m_shards.size());
+    std::vector<std::thread> threads;
+    threads.reserve(m_shards.size());
+    for (std::size_t i = 0; i < m_shards.size(); ++i)
+    {
+        threads.emplace_back([this, &func, &errors, i]
+        {
+            try
+            {
+                auto lease = shard(i);
+                func(i, *lease);
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    for (const auto& error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+void ShardedLitestore::del(const KeyView key)
+{
+    shard(shardOf(key))->del(key);
+}
+
+bool ShardedLitestore::exists(const KeyView key)
+{
+    return shard(shardOf(key))->exists(key);
+}
+
+std::vector<std::string> ShardedLitestore::keys(const KeyView pattern)
+{
+    std::vector<std::string> result;
+    for (std::size_t i = 0; i < m_shards.size(); ++i)
+    {
+        auto lease = shard(i);
+        lease->keys(pattern, [&result](KeyView key)
+        {
+            result.push_back(key.str());
+            return true;
+        });
+    }
+    std::sort(result.begin(), result.end());
+
+    return result;
+}
+
+std::size_t ShardedLitestore::count(const KeyView pattern)
+{
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < m_shards.size(); ++i)
+    {
+        n += shard(i)->count(pattern);
+    }
+    return n;
+}
+
+}  // namespace lscpp
@@ -0,0 +1,109 @@
+/**
+ * Copyright (c) 2018 Markku Linnoskivi
+ *
+ * See the file LICENSE for copying permission.
+ */
+#include "litestorecpp/write_buffer.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+namespace lscpp
+{
+namespace
+{
+inline
+void throwError(const int rc)
+{
+    throw std::runtime_error("Litestore error: " + std::to_string(rc));
+}
+
+void flushPending(detail::PendingWrites& pending)
+{
+    if (pending.entries.empty())
+    {
+        return;
+    }
+    WriteBatch batch;
+    for (const auto& kv : pending.entries)
+    {
+        const auto& e = kv.second;
+        if (e.deleted)
+        {
+            batch.del(kv.first);
+        }
+        else if (e.null)
+        {
+            batch.update(kv.first, nullptr);
+        }
+        else
+        {
+            batch.update(kv.first, e.value);
+        }
+    }
+    pending.store->write(batch);
+    pending.entries.clear();
+}
+
+}  // namespace
+
+WriteBuffer::WriteBuffer(Litestore& store, Transaction& tx)
+    : m_pending(std::make_shared<detail::PendingWrites>())
+{
+    if (tx.state() != Transaction::State::OPEN)
+    {
+        throw std::runtime_error("Transaction not open!");
+    }
+    m_pending->store = &store;
+
+    auto pending = m_pending;
+    tx.beforeCommit([pending] { flushPending(*pending); });
+    tx.onRollback([pending] { pending->entries.clear(); });
+}
+
+void WriteBuffer::del(const KeyView key)
+{
+    m_pending->entries[key.str()] = detail::PendingWrites::Entry{true, false, {}};
+}
+
+void WriteBuffer::flush()
+{
+    flushPending(*m_pending);
+}
+
+void WriteBuffer::put(const KeyView key, litestore_blob_t value)
+{
+    auto& e = m_pending->entries[key.str()];
+    e.deleted = false;
+    e.null = value.data == nullptr;
+    const auto data = static_cast<const char*>(value.data);
+    e.value.assign(data, data ? value.size : 0);
+}
+
+bool WriteBuffer::readImpl(const KeyView key, ReadFunc func, void* userData)
+{
+    const auto it = m_pending->entries.find(key.str());
+    if (it == m_pending->entries.end())
+    {
+        return false;
+    }
+    const auto& e = it->second;
+    if (e.deleted)
+    {
+        throwError(LITESTORE_UNKNOWN_ENTITY);
+    }
+    // null and blob values are read with different functions
+    if (e.null != !func)
+    {
+        throwError(LITESTORE_ERR);
+    }
+    if (func &&
+        func(litestore_make_blob(e.value.data(), e.value.size()),
+             userData) != LITESTORE_OK)
+    {
+        throwError(LITESTORE_ERR);
+    }
+    return true;
+}
+
+}  // namespace lscpp
@@ -0,0 +1,81 @@
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "litestorecpp/async_litestore.hpp"
+
+using namespace lscpp;
+
+TEST_CASE("Async litestore")
+{
+    AsyncLitestore ls(":memory:");
+
+    SECTION("Operations complete in order")
+    {
+        auto created = ls.create("key", 42);
+        auto read = ls.read<int>("key");
+        auto updated = ls.update("key", std::string("abc"));
+        auto readAgain = ls.read<std::string>("key");
+        auto keys = ls.keys("*");
+        auto deleted = ls.del("key");
+
+        created.get();
+        CHECK(read.get() == 42);
+        updated.get();
+        CHECK(readAgain.get() == "abc");
+        CHECK(keys.get() == std::vector<std::string>{"key"});
+        deleted.get();
+        CHECK(ls.keys("*").get().empty());
+    }
+
+    SECTION("Literals are stored as by Litestore")
+    {
+        ls.submit([](Litestore& store)
+        {
+            store.create("direct", "abc");
+        }).get();
+        ls.create("created", "abc").get();
+        ls.update("updated", "abc").get();
+
+        const auto direct = ls.read<std::string>("direct").get();
+        CHECK(direct.compare(0, 3, "abc") == 0);
+        CHECK(ls.read<std::string>("created").get() == direct);
+        CHECK(ls.read<std::string>("updated").get() == direct);
+    }
+
+    SECTION("Errors are delivered through the future")
+    {
+        auto read = ls.read<int>("missing");
+        CHECK_THROWS_AS(read.get(), std::runtime_error);
+    }
+
+    SECTION("Submitted functions run on the executor")
+    {
+        auto sum = ls.submit([](Litestore& store)
+        {
+            auto tx = store.createTx();
+            store.create("a", 1);
+            store.create("b", 2);
+            tx.commit();
+            return store.read<int>("a") + store.read<int>("b");
+        });
+        CHECK(sum.get() == 3);
+    }
+
+    SECTION("Queued operations run before destruction")
+    {
+        int value = 0;
+        {
+            AsyncLitestore other(":memory:");
+            other.create("key", 7);
+            other.post([&](Litestore& store)
+            {
+                value = store.read<int>("key");
+            });
+        }
+        CHECK(value == 7);
+    }
+}
@@ -0,0 +1,49 @@
+#include <string>
+
+#include "catch.hpp"
+
+#include "litestorecpp/bloom_filter.hpp"
+
+using namespace lscpp;
+
+TEST_CASE("Bloom filter")
+{
+    BloomFilter filter(1000, 0.01);
+    REQUIRE(filter.bits() >= 1000);
+    REQUIRE((filter.bits() & (filter.bits() - 1)) == 0);
+    REQUIRE(filter.hashes() >= 1);
+
+    SECTION("Added keys are always found")
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            filter.add(std::to_string(i));
+        }
+        for (int i = 0; i < 1000; ++i)
+        {
+            CHECK(filter.mayContain(std::to_string(i)));
+        }
+    }
+
+    SECTION("False positive rate is near the target")
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            filter.add(std::to_string(i));
+        }
+        int falsePositives = 0;
+        for (int i = 1000; i < 11000; ++i)
+        {
+            falsePositives += filter.mayContain(std::to_string(i)) ? 1 : 0;
+        }
+        CHECK(falsePositives < 300);
+    }
+
+    SECTION("Clear")
+    {
+        filter.add("key");
+        filter.clear();
+
+        CHECK_FALSE(filter.mayContain("key"));
+    }
+}
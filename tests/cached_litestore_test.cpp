@@ -0,0 +1,305 @@
+#include <cstddef>
+#include <cstdio>
+#include <stdexcept>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "litestorecpp/cached_litestore.hpp"
+
+using namespace lscpp;
+
+TEST_CASE("Value cache")
+{
+    ValueCache cache(10);
+
+    SECTION("Put and get")
+    {
+        cache.put("a", BlobView("123", 3));
+
+        const auto v = cache.get("a");
+        REQUIRE(v);
+        CHECK(*v == "123");
+        CHECK(cache.bytes() == 4);
+    }
+
+    SECTION("Least recently used is evicted")
+    {
+        cache.put("a", BlobView("1234", 4));
+        cache.put("b", BlobView("1234", 4));
+        cache.get("a");
+        cache.put("c", BlobView("1234", 4));
+
+        CHECK(cache.get("a"));
+        CHECK_FALSE(cache.get("b"));
+        CHECK(cache.get("c"));
+        CHECK(cache.bytes() <= cache.budget());
+    }
+
+    SECTION("Values larger than budget are not cached")
+    {
+        cache.put("a", BlobView("0123456789", 10));
+
+        CHECK_FALSE(cache.get("a"));
+        CHECK(cache.size() == 0);
+    }
+
+    SECTION("Erase")
+    {
+        cache.put("a", BlobView("1", 1));
+        cache.erase("a");
+
+        CHECK_FALSE(cache.get("a"));
+        CHECK(cache.bytes() == 0);
+    }
+}
+
+TEST_CASE("Sharded value cache")
+{
+    ShardedValueCache cache(4096, 4);
+    REQUIRE(cache.shards() == 4);
+
+    SECTION("Hits and misses are counted per shard")
+    {
+        cache.put("a", BlobView("1", 1), cache.generation("a"));
+
+        CHECK(cache.get("a", [](BlobView v) { CHECK(v.size() == 1); }));
+        CHECK_FALSE(cache.get("b", [](BlobView) {}));
+
+        ShardedValueCache::Stats total{0, 0, 0, 0};
+        for (std::size_t i = 0; i < cache.shards(); ++i)
+        {
+            const auto s = cache.stats(i);
+            total.hits += s.hits;
+            total.misses += s.misses;
+            total.size += s.size;
+        }
+        CHECK(total.hits == 1);
+        CHECK(total.misses == 1);
+        CHECK(total.size == 1);
+    }
+
+    SECTION("Stale generation is not cached")
+    {
+        const auto generation = cache.generation("a");
+        cache.erase("a");
+        cache.put("a", BlobView("1", 1), generation);
+
+        CHECK(cache.size() == 0);
+    }
+
+    SECTION("Concurrent access")
+    {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&cache, t]
+            {
+                for (int i = 0; i < 1000; ++i)
+                {
+                    const auto key = std::to_string((t * 1000 + i) % 64);
+                    if (!cache.get(key, [](BlobView) {}))
+                    {
+                        cache.put(key, BlobView(key.data(), key.size()),
+                                  cache.generation(key));
+                    }
+                }
+            });
+        }
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+        CHECK(cache.size() == 64);
+    }
+}
+
+TEST_CASE("Cached litestore")
+{
+    CachedLitestore ls(":memory:", 1024);
+    REQUIRE(ls.is_open());
+
+    SECTION("Reads fill the cache")
+    {
+        ls.create("key", 42);
+        CHECK(ls.cache().size() == 0);
+
+        CHECK(ls.read<int>("key") == 42);
+        CHECK(ls.cache().size() == 1);
+        CHECK(ls.read<int>("key") == 42);
+    }
+
+    SECTION("Cache hits are counted as hot key accesses")
+    {
+        ls.create("key", 42);
+        ls.store().enableHotKeyTracking();
+        for (int i = 0; i < 3; ++i)
+        {
+            CHECK(ls.read<int>("key") == 42);
+        }
+
+        const auto top = ls.store().hotKeys(1);
+        REQUIRE(top.size() == 1);
+        CHECK(top[0].key == "key");
+        CHECK(top[0].count == 3);
+    }
+
+    SECTION("Read of missing key throws")
+    {
+        CHECK_THROWS_AS(ls.read<int>("key"), std::runtime_error);
+    }
+
+    SECTION("Cached value of wrong type throws")
+    {
+        ls.create("key", std::string("abc"));
+        ls.read<std::string>("key");
+
+        CHECK_THROWS_AS(ls.read<int>("key"), std::runtime_error);
+    }
+
+    SECTION("Null values bypass the cache")
+    {
+        ls.create("key", nullptr);
+
+        CHECK(ls.read<std::nullptr_t>("key") == nullptr);
+        CHECK(ls.cache().size() == 0);
+    }
+
+    SECTION("Update and delete invalidate")
+    {
+        ls.create("key", 42);
+        ls.read<int>("key");
+
+        ls.update("key", 43);
+        CHECK(ls.read<int>("key") == 43);
+
+        ls.del("key");
+        CHECK_THROWS_AS(ls.read<int>("key"), std::runtime_error);
+    }
+
+    SECTION("Rollback invalidates values written in transaction")
+    {
+        ls.create("key", 42);
+        {
+            auto tx = ls.createTx();
+            ls.update("key", 43);
+            CHECK(ls.read<int>("key") == 43);
+            tx.rollback();
+        }
+        CHECK(ls.read<int>("key") == 42);
+
+        {
+            auto tx = ls.createTx();
+            ls.update("key", 44);
+            CHECK(ls.read<int>("key") == 44);
+        }
+        CHECK(ls.read<int>("key") == 42);
+    }
+}
+
+TEST_CASE("Cached litestores sharing a cache")
+{
+    auto cache = std::make_shared<ShardedValueCache>(1024, 2);
+    CachedLitestore ls(Litestore(":memory:"), cache);
+
+    ls.create("key", 42);
+    CHECK(ls.read<int>("key") == 42);
+    CHECK(cache->size() == 1);
+
+    SECTION("Commit drops keys written in transaction")
+    {
+        auto tx = ls.createTx();
+        ls.update("key", 43);
+        CHECK(ls.read<int>("key") == 43);
+        tx.commit();
+
+        CHECK(cache->size() == 0);
+        CHECK(ls.read<int>("key") == 43);
+    }
+
+    SECTION("Uncommitted values are not shared with other instances")
+    {
+        const char* filename = "shared_cache_test.db";
+        std::remove(filename);
+        {
+            CachedLitestore a(Litestore(filename), cache);
+            CachedLitestore b(Litestore(filename), cache);
+            a.create("shared", 42);
+            {
+                auto tx = a.createTx();
+                a.update("shared", 43);
+                CHECK(a.read<int>("shared") == 43);
+                CHECK(b.read<int>("shared") == 42);
+                CHECK(a.preload("*") == 0);
+            }
+            CHECK(a.read<int>("shared") == 42);
+            CHECK(b.read<int>("shared") == 42);
+        }
+        std::remove(filename);
+    }
+}
+
+TEST_CASE("Preloading the cache")
+{
+    SECTION("In-memory store is read with the own handle")
+    {
+        CachedLitestore ls(":memory:", 4096);
+        for (int i = 0; i < 100; ++i)
+        {
+            ls.create("key" + std::to_string(i), i);
+        }
+        ls.create("other", 1);
+        ls.create("keynull", nullptr);
+
+        CHECK(ls.preload("key*", 4) == 100);
+        CHECK(ls.cache().size() == 100);
+        CHECK(ls.read<int>("key42") == 42);
+    }
+
+    SECTION("File is read by several threads")
+    {
+        const char* filename = "preload_test.db";
+        std::remove(filename);
+        {
+            CachedLitestore ls(filename, 1 << 20);
+            {
+                auto tx = ls.createTx();
+                for (int i = 0; i < 1000; ++i)
+                {
+                    ls.create("key" + std::to_string(i), i);
+                }
+                tx.commit();
+            }
+
+            std::size_t calls = 0;
+            std::size_t last = 0;
+            bool ordered = true;
+            const auto loaded = ls.preload("key*", 4,
+                                           [&](std::size_t done,
+                                               std::size_t total)
+            {
+                ++calls;
+                ordered = ordered && done > last && total == 1000;
+                last = done;
+            });
+
+            CHECK(ordered);
+            CHECK(loaded == 1000);
+            CHECK(last == 1000);
+            CHECK(calls > 1);
+            CHECK(ls.cache().size() == 1000);
+            CHECK(ls.read<int>("key999") == 999);
+
+            CHECK_THROWS_AS(ls.preload("key*", 2,
+                                       [](std::size_t, std::size_t)
+                                       {
+                                           throw std::logic_error("fail");
+                                       }),
+                            std::logic_error);
+        }
+        std::remove(filename);
+    }
+}
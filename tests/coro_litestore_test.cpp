@@ -0,0 +1,117 @@
+#include <coroutine>
+#include <exception>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "litestorecpp/coro_litestore.hpp"
+
+using namespace lscpp;
+
+namespace
+{
+/**
+ * Eagerly started coroutine completing a future.
+ */
+struct Task
+{
+    struct promise_type
+    {
+        std::promise<void> done;
+
+        Task get_return_object() { return Task{done.get_future()}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() { done.set_value(); }
+        void unhandled_exception() { done.set_exception(std::current_exception()); }
+    };
+
+    std::future<void> future;
+};
+
+}  // namespace
+
+TEST_CASE("Coroutine litestore")
+{
+    CoroLitestore ls(":memory:");
+
+    SECTION("Awaiting operations")
+    {
+        auto task = [](CoroLitestore& ls) -> Task
+        {
+            co_await ls.createAsync("key", 42);
+            CHECK(co_await ls.readAsync<int>("key") == 42);
+            co_await ls.updateAsync("key", std::string("abc"));
+            CHECK(co_await ls.readAsync<std::string>("key") == "abc");
+            co_await ls.delAsync("key");
+        }(ls);
+        task.future.get();
+
+        CHECK(ls.executor().keys("*").get().empty());
+    }
+
+    SECTION("Literals are stored as by Litestore")
+    {
+        ls.executor().submit([](Litestore& store)
+        {
+            store.create("direct", "abc");
+        }).get();
+
+        auto task = [](CoroLitestore& ls) -> Task
+        {
+            co_await ls.createAsync("created", "abc");
+            co_await ls.updateAsync("updated", "abc");
+        }(ls);
+        task.future.get();
+
+        const auto direct = ls.executor().read<std::string>("direct").get();
+        CHECK(ls.executor().read<std::string>("created").get() == direct);
+        CHECK(ls.executor().read<std::string>("updated").get() == direct);
+    }
+
+    SECTION("Errors are thrown from co_await")
+    {
+        auto task = [](CoroLitestore& ls) -> Task
+        {
+            co_await ls.readAsync<int>("missing");
+        }(ls);
+        CHECK_THROWS_AS(task.future.get(), std::runtime_error);
+    }
+
+    SECTION("Generating keys")
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            auto key = std::to_string(i);
+            ls.executor().create("key" + std::string(4 - key.size(), '0') + key, i).get();
+        }
+        ls.executor().create("other", 0).get();
+
+        std::vector<std::string> keys;
+        auto task = [](CoroLitestore& ls, std::vector<std::string>& keys) -> Task
+        {
+            auto gen = ls.keysAsync("key*");
+            while (co_await gen.next())
+            {
+                keys.push_back(gen.key());
+                if (keys.size() == 500)
+                {
+                    // created after the snapshot
+                    co_await ls.createAsync("key0499a", 0);
+                }
+            }
+        }(ls, keys);
+        task.future.get();
+
+        REQUIRE(keys.size() == 1000);
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            auto key = std::to_string(i);
+            CHECK(keys[i] == "key" + std::string(4 - key.size(), '0') + key);
+        }
+        CHECK(ls.executor().keys("key*").get().size() == 1001);
+    }
+}
@@ -0,0 +1,136 @@
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "litestorecpp/group_commit_writer.hpp"
+
+using namespace lscpp;
+
+TEST_CASE("Group commit writer")
+{
+    const char* filename = "group_commit_test.db";
+    std::remove(filename);
+    {
+        SECTION("Writes are committed")
+        {
+            {
+                GroupCommitWriter writer(filename);
+                writer.create("a", 1).get();
+                writer.create("b", std::string("abc")).get();
+                writer.update("a", 2).get();
+                writer.del("b").get();
+            }
+            Litestore ls(filename);
+            CHECK(ls.read<int>("a") == 2);
+            CHECK_FALSE(ls.exists("b"));
+        }
+
+        SECTION("Concurrent writes share transactions")
+        {
+            const int threads = 8;
+            const int writes = 100;
+            std::uint64_t commits = 0;
+            {
+                GroupCommitWriter writer(filename);
+                std::vector<std::thread> producers;
+                for (int t = 0; t < threads; ++t)
+                {
+                    producers.emplace_back([&writer, t]
+                    {
+                        std::vector<std::future<void>> done;
+                        for (int i = 0; i < writes; ++i)
+                        {
+                            done.push_back(writer.create(
+                                std::to_string(t) + "_" + std::to_string(i), i));
+                        }
+                        for (auto& f : done)
+                        {
+                            f.get();
+                        }
+                    });
+                }
+                for (auto& p : producers)
+                {
+                    p.join();
+                }
+                commits = writer.commits();
+            }
+            CHECK(commits > 0);
+            Litestore ls(filename);
+            CHECK(ls.count("*") == static_cast<std::size_t>(threads * writes));
+        }
+
+        SECTION("Writes queued meanwhile share one commit")
+        {
+            {
+                Litestore ls(filename);
+                ls.create("dup", 0);
+            }
+            // the failing write below blocks the writer thread here
+            std::atomic<bool> blocked(false);
+            std::promise<void> entered;
+            std::promise<void> release;
+            auto released = release.get_future().share();
+            Litestore store(filename, [&](int, const char*)
+            {
+                if (!blocked.exchange(true))
+                {
+                    entered.set_value();
+                    released.wait();
+                }
+            });
+            GroupCommitWriter writer(std::move(store));
+
+            auto dup = writer.create("dup", 1);
+            entered.get_future().wait();
+            std::vector<std::future<void>> done;
+            for (int i = 0; i < 50; ++i)
+            {
+                done.push_back(writer.create(std::to_string(i), i));
+            }
+            release.set_value();
+
+            CHECK_THROWS_AS(dup.get(), std::runtime_error);
+            for (auto& f : done)
+            {
+                f.get();
+            }
+            CHECK(writer.commits() == 1);
+        }
+
+        SECTION("A failing write only fails its own future")
+        {
+            GroupCommitWriter writer(filename);
+            writer.create("key", 1).get();
+
+            auto a = writer.create("a", 1);
+            auto dup = writer.create("key", 2);
+            auto b = writer.create("b", 2);
+
+            CHECK_NOTHROW(a.get());
+            CHECK_THROWS_AS(dup.get(), std::runtime_error);
+            CHECK_NOTHROW(b.get());
+        }
+
+        SECTION("Queued writes are committed on destruction")
+        {
+            {
+                GroupCommitWriter writer(filename);
+                for (int i = 0; i < 10; ++i)
+                {
+                    writer.create(std::to_string(i), i);
+                }
+            }
+            Litestore ls(filename);
+            CHECK(ls.count("*") == 10);
+        }
+    }
+    std::remove(filename);
+}
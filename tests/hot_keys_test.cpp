@@ -0,0 +1,132 @@
+#include <string>
+
+#include "catch.hpp"
+
+#include "litestorecpp/hot_keys.hpp"
+
+using namespace lscpp;
+
+TEST_CASE("Hot key tracker")
+{
+    HotKeyTracker tracker(1, 4);
+
+    SECTION("Estimates never undercount")
+    {
+        for (int i = 0; i < 100; ++i)
+        {
+            for (int j = 0; j <= i % 10; ++j)
+            {
+                tracker.record(std::to_string(i));
+            }
+        }
+        for (int i = 0; i < 100; ++i)
+        {
+            CHECK(tracker.estimate(std::to_string(i)) >=
+                  static_cast<std::uint64_t>(i % 10 + 1));
+        }
+    }
+
+    SECTION("Most accessed keys are reported in order")
+    {
+        for (int i = 0; i < 200; ++i)
+        {
+            tracker.record("cold" + std::to_string(i));
+            if (i % 2 == 0)
+            {
+                tracker.record("hot");
+            }
+            if (i % 4 == 0)
+            {
+                tracker.record("warm");
+            }
+        }
+        const auto top = tracker.top(2);
+        REQUIRE(top.size() == 2);
+        CHECK(top[0].key == "hot");
+        CHECK(top[0].count >= 100);
+        CHECK(top[1].key == "warm");
+        CHECK(top[1].count >= 50);
+    }
+
+    SECTION("Least accessed candidate is replaced")
+    {
+        HotKeyTracker small(1, 2);
+        small.record("a");
+        for (int i = 0; i < 5; ++i)
+        {
+            small.record("b");
+        }
+        small.record("c");
+        // not hotter than "a", which stays
+        CHECK(small.top(2)[1].key == "a");
+        small.record("c");
+        small.record("c");
+
+        const auto top = small.top(2);
+        REQUIRE(top.size() == 2);
+        CHECK(top[0].key == "b");
+        CHECK(top[0].count == 5);
+        CHECK(top[1].key == "c");
+        CHECK(top[1].count == 3);
+    }
+
+    SECTION("Sampled counts are scaled")
+    {
+        HotKeyTracker sampled(4, 4);
+        for (int i = 0; i < 400; ++i)
+        {
+            sampled.record("key");
+        }
+        const auto top = sampled.top(1);
+        REQUIRE(top.size() == 1);
+        CHECK(top[0].count == 400);
+    }
+
+    SECTION("Clear")
+    {
+        tracker.record("key");
+        tracker.clear();
+
+        CHECK(tracker.top(1).empty());
+        CHECK(tracker.estimate("key") == 0);
+    }
+}
+
+TEST_CASE("Hot key tracking")
+{
+    Litestore ls(":memory:");
+    ls.create("a", 1);
+    ls.create("b", 2);
+    ls.create("c", 3);
+
+    SECTION("Disabled by default")
+    {
+        ls.read<int>("a");
+        CHECK(ls.hotKeys(1).empty());
+    }
+
+    SECTION("Reads, updates and deletes are counted")
+    {
+        ls.enableHotKeyTracking();
+        for (int i = 0; i < 5; ++i)
+        {
+            ls.read<int>("b");
+        }
+        ls.update("a", 4);
+        ls.update("a", 5);
+        ls.readView("a", [](BlobView) {});
+        ls.del("c");
+
+        const auto top = ls.hotKeys(3);
+        REQUIRE(top.size() == 3);
+        CHECK(top[0].key == "b");
+        CHECK(top[0].count == 5);
+        CHECK(top[1].key == "a");
+        CHECK(top[1].count == 3);
+        CHECK(top[2].key == "c");
+        CHECK(top[2].count == 1);
+
+        ls.disableHotKeyTracking();
+        CHECK(ls.hotKeys(3).empty());
+    }
+}
@@ -0,0 +1,118 @@
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "litestorecpp/litestore_pool.hpp"
+
+using namespace lscpp;
+
+TEST_CASE("Litestore pool")
+{
+    const char* filename = "pool_test.db";
+    std::remove(filename);
+    {
+        LitestorePool pool(filename, 1, 3);
+        REQUIRE(pool.size() == 1);
+        REQUIRE(pool.idle() == 1);
+
+        SECTION("Leases return handles to the pool")
+        {
+            {
+                auto lease = pool.acquire();
+                REQUIRE(lease);
+                CHECK(lease->is_open());
+                CHECK(pool.idle() == 0);
+                lease->create("key", 42);
+            }
+            CHECK(pool.idle() == 1);
+            CHECK(pool.acquire()->read<int>("key") == 42);
+        }
+
+        SECTION("Grows to the maximum size")
+        {
+            auto a = pool.acquire();
+            auto b = pool.acquire();
+            auto c = pool.acquire();
+            CHECK(pool.size() == 3);
+            CHECK_FALSE(pool.tryAcquire());
+
+            b.release();
+            CHECK_FALSE(b);
+            auto d = pool.tryAcquire();
+            CHECK(d);
+            CHECK(pool.size() == 3);
+        }
+
+        SECTION("Shrinks to the minimum size")
+        {
+            {
+                auto a = pool.acquire();
+                auto b = pool.acquire();
+                auto c = pool.acquire();
+            }
+            CHECK(pool.idle() == 3);
+            CHECK(pool.shrink() == 2);
+            CHECK(pool.size() == 1);
+            CHECK(pool.idle() == 1);
+        }
+
+        SECTION("Closed handles are not reused")
+        {
+            {
+                auto lease = pool.acquire();
+                lease->close();
+            }
+            CHECK(pool.size() == 0);
+            CHECK(pool.acquire()->is_open());
+        }
+
+        SECTION("Moved leases")
+        {
+            auto a = pool.acquire();
+            auto b = std::move(a);
+            CHECK_FALSE(a);
+            CHECK(b);
+            a = std::move(b);
+            CHECK(a);
+            CHECK(pool.idle() == 0);
+        }
+
+        SECTION("Acquire blocks until a handle is returned")
+        {
+            pool.acquire()->create("counter", 0);
+
+            std::atomic<int> leased(0);
+            std::atomic<int> maxLeased(0);
+            std::vector<std::thread> threads;
+            for (int t = 0; t < 8; ++t)
+            {
+                threads.emplace_back([&]
+                {
+                    for (int i = 0; i < 10; ++i)
+                    {
+                        auto lease = pool.acquire();
+                        const auto n = ++leased;
+                        auto max = maxLeased.load();
+                        while (n > max && !maxLeased.compare_exchange_weak(max, n))
+                        {}
+                        lease->read<int>("counter");
+                        --leased;
+                    }
+                });
+            }
+            for (auto& t : threads)
+            {
+                t.join();
+            }
+            CHECK(maxLeased <= 3);
+            CHECK(pool.size() <= 3);
+            CHECK(pool.idle() == pool.size());
+        }
+    }
+    std::remove(filename);
+}
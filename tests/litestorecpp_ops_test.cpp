@@ -1,4 +1,13 @@
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
 #include <type_traits>
 
 #include "catch.hpp"
@@ -7,6 +16,33 @@
 
 using namespace lscpp;
 
+namespace
+{
+struct Legacy
+{
+    int a;
+    int b;
+};
+}
+
+namespace lscpp
+{
+// written against the protocol that only had data()
+template <>
+struct BlobOutput<Legacy>
+{
+    Legacy& value;
+
+    BlobOutput(Legacy& v)
+        : value(v)
+    {}
+    void* data()
+    {
+        return &value;
+    }
+};
+}
+
 TEST_CASE("Operations throw if not opened")
 {
     Litestore ls;
@@ -116,6 +152,259 @@ TEST_CASE("CRUD on blob type")
     }
 }
 
+TEST_CASE("BlobOutput specializations with data() only")
+{
+    Litestore ls(":memory:");
+    ls.create("key", Legacy{1, 2});
+
+    const auto value = ls.read<Legacy>("key");
+    CHECK(value.a == 1);
+    CHECK(value.b == 2);
+}
+
+TEST_CASE("CRUD on variable length types")
+{
+    Litestore ls{":memory:"};
+    REQUIRE(ls.is_open());
+
+    SECTION("string")
+    {
+        const std::string value(1000, 'x');
+        ls.create("key", value);
+
+        CHECK(ls.read<std::string>("key") == value);
+    }
+
+    SECTION("empty string")
+    {
+        ls.create("key", std::string{});
+
+        CHECK(ls.read<std::string>("key").empty());
+    }
+
+    SECTION("vector")
+    {
+        const std::vector<int> value{1, 2, 3, 4};
+        ls.create("key", value);
+
+        CHECK(ls.read<std::vector<int>>("key") == value);
+    }
+
+    SECTION("empty vector")
+    {
+        ls.update("key", std::vector<int>{});
+
+        CHECK(ls.read<std::vector<int>>("key").empty());
+    }
+
+    SECTION("array")
+    {
+        const std::array<int, 3> value{{1, 2, 3}};
+        ls.create("key", value);
+
+        const auto rv = ls.read<std::array<int, 3>>("key");
+        CHECK(rv == value);
+    }
+
+    SECTION("Size mismatch throws")
+    {
+        ls.create("key", std::string("abc"));
+
+        CHECK_THROWS_AS(ls.read<int>("key"), std::runtime_error);
+        CHECK_THROWS_AS(ls.read<std::vector<int>>("key"), std::runtime_error);
+    }
+}
+
+TEST_CASE("Reading a view")
+{
+    Litestore ls(":memory:");
+
+    SECTION("Throws if no handle")
+    {
+        Litestore closed;
+        CHECK_THROWS_AS(closed.readView("key", [](BlobView) {}),
+                        std::runtime_error);
+    }
+
+    SECTION("Throws if not found")
+    {
+        CHECK_THROWS_AS(ls.readView("key", [](BlobView) {}),
+                        std::runtime_error);
+    }
+
+    SECTION("View points to the stored bytes")
+    {
+        ls.create("key", 42);
+
+        int i = 0;
+        std::size_t size = 0;
+        ls.readView("key", [&](BlobView v)
+        {
+            size = v.size();
+            std::memcpy(&i, v.data(), v.size());
+        });
+
+        CHECK(size == sizeof(int));
+        CHECK(i == 42);
+    }
+
+    SECTION("Exceptions from the function are propagated")
+    {
+        ls.create("key", 42);
+
+        CHECK_THROWS_AS(ls.readView("key", [](BlobView)
+                                    {
+                                        throw std::logic_error("fail");
+                                    }),
+                        std::logic_error);
+    }
+
+    SECTION("Trying to read a missing or null value is not an error")
+    {
+        int errors = 0;
+        Litestore counted(":memory:", [&](int, const char*) { ++errors; });
+        counted.create("key", 42);
+        counted.create("null", nullptr);
+
+        bool called = false;
+        const auto func = [&](BlobView) { called = true; };
+        CHECK_FALSE(counted.tryReadView("missing", func));
+        CHECK_FALSE(counted.tryReadView("null", func));
+        CHECK_FALSE(called);
+        CHECK(counted.tryReadView("key", func));
+        CHECK(called);
+        CHECK(errors == 0);
+    }
+}
+
+TEST_CASE("Reading into a buffer")
+{
+    Litestore ls(":memory:");
+
+    SECTION("Throws if not found")
+    {
+        char buffer[8];
+        CHECK_THROWS_AS(ls.readInto("key", buffer, sizeof(buffer)),
+                        std::runtime_error);
+    }
+
+    SECTION("Copies when the blob fits")
+    {
+        ls.create("key", std::string("abc"));
+
+        char buffer[8] = {};
+        const auto size = ls.readInto("key", buffer, sizeof(buffer));
+
+        CHECK(size == 3);
+        CHECK(std::string(buffer, size) == "abc");
+    }
+
+    SECTION("Reports required size when the blob does not fit")
+    {
+        ls.create("key", std::string("abcdef"));
+
+        char buffer[4] = {};
+        const auto size = ls.readInto("key", buffer, sizeof(buffer));
+
+        CHECK(size == 6);
+        CHECK(buffer[0] == '\0');
+    }
+}
+
+TEST_CASE("Reading many keys")
+{
+    Litestore ls(":memory:");
+
+    SECTION("Throws if no handle")
+    {
+        Litestore closed;
+        CHECK_THROWS_AS(closed.readMany({"key"}), std::runtime_error);
+    }
+
+    SECTION("Values and missing keys are reported in order")
+    {
+        ls.create("a", std::string("one"));
+        ls.create("c", std::string("three"));
+
+        const auto rv = ls.readMany({"a", "b", "c"});
+
+        REQUIRE(rv.size() == 3);
+        CHECK(rv.found(0));
+        CHECK(std::string(static_cast<const char*>(rv[0].data()),
+                          rv[0].size()) == "one");
+        CHECK_FALSE(rv.found(1));
+        CHECK(rv[1].empty());
+        CHECK(rv.found(2));
+        CHECK(std::string(static_cast<const char*>(rv[2].data()),
+                          rv[2].size()) == "three");
+    }
+
+    SECTION("Null values are reported per key")
+    {
+        int errors = 0;
+        Litestore counted(":memory:", [&](int, const char*) { ++errors; });
+        counted.create("a", 1);
+        counted.create("n", nullptr);
+
+        const auto rv = counted.readMany({"a", "n", "b"});
+
+        REQUIRE(rv.size() == 3);
+        CHECK(rv.found(0));
+        CHECK_FALSE(rv.null(0));
+        CHECK(rv[0].size() == sizeof(int));
+        CHECK(rv.found(1));
+        CHECK(rv.null(1));
+        CHECK(rv[1].empty());
+        CHECK_FALSE(rv.found(2));
+        CHECK_FALSE(rv.null(2));
+        CHECK(errors == 0);
+    }
+
+    SECTION("Result is reused")
+    {
+        ls.create("a", 1);
+
+        MultiRead rv;
+        ls.readMany({"a", "a"}, rv);
+        ls.readMany({"a"}, rv);
+
+        CHECK(rv.size() == 1);
+        CHECK(rv.found(0));
+    }
+
+    SECTION("Works inside a transaction")
+    {
+        auto tx = ls.createTx();
+        ls.create("a", 1);
+
+        const auto rv = ls.readMany({"a"});
+        tx.rollback();
+
+        CHECK(rv.found(0));
+    }
+}
+
+TEST_CASE("Keys as views")
+{
+    Litestore ls(":memory:");
+    const char buffer[] = "tenant/entity/id";
+    const KeyView key(buffer, 6);
+
+    ls.create(key, 42);
+
+    CHECK(ls.read<int>("tenant") == 42);
+    CHECK(ls.read<int>(std::string("tenant")) == 42);
+    CHECK(ls.exists(key));
+    REQUIRE(ls.keys(KeyView(buffer, 3)).empty());
+    CHECK(ls.keys("ten*").size() == 1);
+
+    ls.update(key, 43);
+    CHECK(ls.read<int>(key) == 43);
+
+    ls.del(key);
+    CHECK_FALSE(ls.exists("tenant"));
+}
+
 TEST_CASE("Delete")
 {
     SECTION("Throws if no handle")
@@ -141,6 +430,229 @@ TEST_CASE("Delete")
     }
 }
 
+TEST_CASE("Existence and counting")
+{
+    Litestore ls(":memory:");
+    ls.create("key1", 1);
+    ls.create("key2", nullptr);
+    ls.create("k*", 3);
+
+    SECTION("Throws if no handle")
+    {
+        Litestore closed;
+        CHECK_THROWS_AS(closed.exists("key1"), std::runtime_error);
+        CHECK_THROWS_AS(closed.count("*"), std::runtime_error);
+    }
+
+    SECTION("Exists")
+    {
+        CHECK(ls.exists("key1"));
+        CHECK(ls.exists("key2"));
+        CHECK(ls.exists("k*"));
+        CHECK_FALSE(ls.exists("key3"));
+        CHECK_FALSE(ls.exists("key"));
+    }
+
+    SECTION("Count")
+    {
+        CHECK(ls.count("*") == 3);
+        CHECK(ls.count("key*") == 2);
+        CHECK(ls.count("foo") == 0);
+    }
+}
+
+TEST_CASE("Key filter")
+{
+    Litestore ls(":memory:");
+    ls.create("key1", 1);
+    ls.create("key2", nullptr);
+
+    SECTION("Throws if no handle")
+    {
+        Litestore closed;
+        CHECK_THROWS_AS(closed.enableKeyFilter(10), std::runtime_error);
+    }
+
+    SECTION("Existing and new keys pass the filter")
+    {
+        ls.enableKeyFilter(100);
+        ls.update("key3", 3);
+        WriteBatch batch;
+        batch.create("key4", 4);
+        ls.write(batch);
+
+        CHECK(ls.read<int>("key1") == 1);
+        CHECK(ls.read<std::nullptr_t>("key2") == nullptr);
+        CHECK(ls.read<int>("key3") == 3);
+        CHECK(ls.exists("key4"));
+    }
+
+    SECTION("Absent keys are rejected")
+    {
+        ls.enableKeyFilter(100);
+
+        CHECK_FALSE(ls.exists("foo"));
+        CHECK_THROWS_AS(ls.read<int>("foo"), std::runtime_error);
+        CHECK_FALSE(ls.readMany({"foo"}).found(0));
+    }
+}
+
+TEST_CASE("Keys cache")
+{
+    Litestore ls(":memory:");
+    ls.create("key1", 1);
+
+    SECTION("Throws if no handle")
+    {
+        Litestore closed;
+        CHECK_THROWS_AS(closed.enableKeysCache(4), std::runtime_error);
+    }
+
+    SECTION("Results follow writes")
+    {
+        ls.enableKeysCache(4);
+        CHECK(ls.keys("*").size() == 1);
+        CHECK(ls.keys("*").size() == 1);
+
+        ls.create("key2", 2);
+        CHECK(ls.keys("*").size() == 2);
+        CHECK(ls.count("*") == 2);
+
+        ls.update("key3", 3);
+        CHECK(ls.keys("*").size() == 3);
+
+        ls.del("key1");
+        CHECK(ls.keys("*").size() == 2);
+
+        WriteBatch batch;
+        batch.del("key2");
+        ls.write(batch);
+        CHECK(ls.keys("*").size() == 1);
+    }
+
+    SECTION("Results follow rollback")
+    {
+        ls.enableKeysCache(4);
+        {
+            auto tx = ls.createTx();
+            ls.create("key2", 2);
+            CHECK(ls.keys("*").size() == 2);
+        }
+        CHECK(ls.keys("*").size() == 1);
+    }
+
+    SECTION("Repeated calls share the result")
+    {
+        ls.enableKeysCache(4);
+        const auto first = ls.sharedKeys("*");
+        REQUIRE(first->size() == 1);
+        CHECK(ls.sharedKeys("*") == first);
+
+        ls.create("key2", 2);
+        const auto second = ls.sharedKeys("*");
+        CHECK(second != first);
+        CHECK(second->size() == 2);
+        CHECK(first->size() == 1);
+    }
+
+    SECTION("Repeated calls do not query the store")
+    {
+        const char* filename = "keys_cache_test.db";
+        std::remove(filename);
+        {
+            Litestore cached(filename);
+            Litestore other(filename);
+            cached.create("key1", 1);
+            cached.enableKeysCache(4);
+            CHECK(cached.keys("*").size() == 1);
+            CHECK(cached.count("*") == 1);
+
+            // not seen by the memoized results, see enableKeysCache()
+            other.create("key2", 2);
+            CHECK(cached.keys("*").size() == 1);
+            CHECK(cached.sharedKeys("*")->size() == 1);
+            CHECK(cached.count("*") == 1);
+
+            cached.disableKeysCache();
+            CHECK(cached.keys("*").size() == 2);
+        }
+        std::remove(filename);
+    }
+
+    SECTION("More patterns than capacity")
+    {
+        ls.enableKeysCache(1);
+
+        CHECK(ls.keys("key*").size() == 1);
+        CHECK(ls.keys("foo*").empty());
+        CHECK(ls.keys("key*").size() == 1);
+    }
+}
+
+TEST_CASE("Write batch")
+{
+    Litestore ls(":memory:");
+
+    SECTION("Throws if no handle")
+    {
+        Litestore closed;
+        WriteBatch batch;
+        CHECK_THROWS_AS(closed.write(batch), std::runtime_error);
+    }
+
+    SECTION("Operations are applied in order")
+    {
+        ls.create("gone", 1);
+
+        WriteBatch batch;
+        batch.create("a", 1);
+        batch.update("a", 2);
+        batch.create("s", std::string("str"));
+        batch.create("null", nullptr);
+        batch.del("gone");
+        REQUIRE(batch.size() == 5);
+
+        ls.write(batch);
+
+        CHECK(ls.read<int>("a") == 2);
+        CHECK(ls.read<std::string>("s") == "str");
+        CHECK(ls.read<std::nullptr_t>("null") == nullptr);
+        CHECK_THROWS_AS(ls.read<int>("gone"), std::runtime_error);
+    }
+
+    SECTION("Failing operation rolls back the batch")
+    {
+        ls.create("a", 1);
+
+        WriteBatch batch;
+        batch.create("b", 2);
+        batch.create("a", 3);
+
+        CHECK_THROWS_AS(ls.write(batch), std::runtime_error);
+        CHECK_THROWS_AS(ls.read<int>("b"), std::runtime_error);
+        CHECK(ls.read<int>("a") == 1);
+    }
+
+    SECTION("Empty key and value")
+    {
+        WriteBatch batch;
+        batch.create("", std::string());
+
+        ls.write(batch);
+
+        CHECK(ls.read<std::string>("").empty());
+    }
+
+    SECTION("Clear empties the batch")
+    {
+        WriteBatch batch;
+        batch.create("a", 1);
+        batch.clear();
+
+        CHECK(batch.empty());
+    }
+}
+
 TEST_CASE("Error function is called")
 {
     bool called = false;
@@ -153,6 +665,18 @@ TEST_CASE("Error function is called")
     CHECK(called);
 }
 
+TEST_CASE("Error function is called after move")
+{
+    bool called = false;
+    Litestore src{":memory:", [&](const int, const char*) { called = true; }};
+    Litestore ls = std::move(src);
+
+    ls.create("key", nullptr);
+    CHECK_THROWS_AS(ls.create("key", nullptr), std::runtime_error);
+
+    CHECK(called);
+}
+
 TEST_CASE("Reading keys")
 {
     Litestore ls(":memory:");
@@ -180,6 +704,59 @@ TEST_CASE("Reading keys")
         CHECK(keys[2] == "key3");
     }
 
+    SECTION("Streaming visits every key")
+    {
+        auto tx = ls.createTx();
+        ls.create("key1", nullptr);
+        ls.create("key2", nullptr);
+
+        std::vector<std::string> keys;
+        ls.keys("*", [&](KeyView key)
+        {
+            keys.push_back(key.str());
+            return true;
+        });
+        tx.rollback();
+
+        REQUIRE(keys.size() == 2);
+        CHECK(keys[0] == "key1");
+        CHECK(keys[1] == "key2");
+    }
+
+    SECTION("Streaming stops early without reporting an error")
+    {
+        bool error = false;
+        Litestore els(":memory:", [&](const int, const char*) { error = true; });
+        els.create("key1", nullptr);
+        els.create("key2", nullptr);
+
+        int visited = 0;
+        els.keys("*", [&](KeyView)
+        {
+            ++visited;
+            return false;
+        });
+
+        CHECK(visited == 1);
+        CHECK_FALSE(error);
+    }
+
+    SECTION("Arena receives every key")
+    {
+        auto tx = ls.createTx();
+        ls.create("key1", nullptr);
+        ls.create("key2", nullptr);
+
+        KeyArena arena;
+        arena.add(std::string("stale"));
+        ls.keys("*", arena);
+        tx.rollback();
+
+        REQUIRE(arena.size() == 2);
+        CHECK(arena[0] == KeyView(std::string("key1")));
+        CHECK(arena[1].str() == "key2");
+    }
+
     SECTION("Get with more specific pattern")
     {
         auto tx = ls.createTx();
@@ -196,4 +773,254 @@ TEST_CASE("Reading keys")
         CHECK(keys[1] == "key2");
         CHECK(keys[2] == "key3");
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Scanning keys")
+{
+    Litestore ls(":memory:");
+    ls.create("t1/b", nullptr);
+    ls.create("t1/a", nullptr);
+    ls.create("t1/c", nullptr);
+    ls.create("t2/a", nullptr);
+    ls.create("t*/a", nullptr);
+
+    SECTION("Prefix scan returns sorted matches")
+    {
+        const auto keys = ls.scanPrefix("t1/");
+
+        REQUIRE(keys.size() == 3);
+        CHECK(keys[0] == "t1/a");
+        CHECK(keys[1] == "t1/b");
+        CHECK(keys[2] == "t1/c");
+    }
+
+    SECTION("Prefix is matched literally")
+    {
+        const auto keys = ls.scanPrefix("t*");
+
+        REQUIRE(keys.size() == 1);
+        CHECK(keys[0] == "t*/a");
+    }
+
+    SECTION("Range excludes the end")
+    {
+        const auto keys = ls.scanRange("t1/b", "t2/a");
+
+        REQUIRE(keys.size() == 2);
+        CHECK(keys[0] == "t1/b");
+        CHECK(keys[1] == "t1/c");
+    }
+
+    SECTION("Range without end and with limit")
+    {
+        const auto keys = ls.scanRange("t1/", "", 2);
+
+        REQUIRE(keys.size() == 2);
+        CHECK(keys[0] == "t1/a");
+        CHECK(keys[1] == "t1/b");
+    }
+}
+
+TEST_CASE("Scanning a large range with a limit")
+{
+    Litestore ls(":memory:");
+    std::vector<std::string> all;
+    {
+        auto tx = ls.createTx();
+        for (int i = 0; i < 3000; ++i)
+        {
+            auto key = std::to_string(i);
+            key = "k" + std::string(4 - key.size(), '0') + key;
+            ls.create(key, i);
+            all.push_back(key);
+        }
+        for (const auto& key : {"a", "k", "k0", "l", "z\xc3\xa9", "\xc3\xa9",
+                                "\xc3\xa9t\xc3\xa9"})
+        {
+            ls.create(key, 0);
+            all.push_back(key);
+        }
+        tx.commit();
+    }
+    std::sort(all.begin(), all.end());
+
+    const auto expected = [&](const std::string& begin,
+                              const std::string& end,
+                              const std::size_t limit)
+    {
+        std::vector<std::string> keys;
+        for (const auto& key : all)
+        {
+            if (!(key < begin) && (end.empty() || key < end) &&
+                (limit == 0 || keys.size() < limit))
+            {
+                keys.push_back(key);
+            }
+        }
+        return keys;
+    };
+
+    SECTION("Open-ended range")
+    {
+        CHECK(ls.scanRange("k0500", "", 10) == expected("k0500", "", 10));
+        CHECK(ls.scanRange("", "", 3) == expected("", "", 3));
+        CHECK(ls.scanRange("k2995", "", 20) == expected("k2995", "", 20));
+    }
+
+    SECTION("Bounds without a common prefix")
+    {
+        CHECK(ls.scanRange("a", "l", 5) == expected("a", "l", 5));
+        CHECK(ls.scanRange("k1", "z", 2000) == expected("k1", "z", 2000));
+    }
+
+    SECTION("Keys with non-ASCII bytes")
+    {
+        CHECK(ls.scanRange("l", "", 10) == expected("l", "", 10));
+        // the bounds share only the first byte of their first character
+        CHECK(ls.scanRange("\xc3\xa9", "\xc3\xaa", 10).size() == 2);
+        CHECK(ls.scanRange("\xc3\xa9", "\xc3\xaa", 1) ==
+              expected("\xc3\xa9", "\xc3\xaa", 1));
+    }
+
+    SECTION("Limit larger than the range")
+    {
+        CHECK(ls.scanRange("k0995", "k1005", 100) ==
+              expected("k0995", "k1005", 100));
+    }
+}
+
+TEST_CASE("Visiting keys and values")
+{
+    bool error = false;
+    Litestore ls(":memory:", [&](const int, const char*) { error = true; });
+    ls.create("a", std::string("one"));
+    ls.create("b", nullptr);
+    ls.create("c", std::string("three"));
+
+    SECTION("Every entry is visited")
+    {
+        std::vector<std::string> entries;
+        ls.forEach("*", [&](KeyView key, BlobView value)
+        {
+            entries.push_back(
+                key.str() + "="
+                + std::string(static_cast<const char*>(value.data()),
+                              value.size()));
+            return true;
+        });
+
+        REQUIRE(entries.size() == 3);
+        CHECK(entries[0] == "a=one");
+        CHECK(entries[1] == "b=");
+        CHECK(entries[2] == "c=three");
+        CHECK_FALSE(error);
+    }
+
+    SECTION("Stops early")
+    {
+        int visited = 0;
+        ls.forEach("*", [&](KeyView, BlobView)
+        {
+            ++visited;
+            return false;
+        });
+
+        CHECK(visited == 1);
+        CHECK_FALSE(error);
+    }
+
+    SECTION("Exceptions from the function are propagated")
+    {
+        CHECK_THROWS_AS(ls.forEach("*", [](KeyView, BlobView) -> bool
+                                   {
+                                       throw std::logic_error("fail");
+                                   }),
+                        std::logic_error);
+    }
+}
+
+TEST_CASE("Visiting keys and values in parallel")
+{
+    const auto visitAll = [](Litestore& ls,
+                             std::size_t threads,
+                             const char* pattern = "key*")
+    {
+        std::mutex mutex;
+        std::map<std::string, int> seen;
+        std::size_t duplicates = 0;
+        ls.parallelForEach(pattern, [&](KeyView key, BlobView value)
+        {
+            int i = 0;
+            std::memcpy(&i, value.data(), sizeof(i));
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!seen.emplace(key.str(), i).second)
+            {
+                ++duplicates;
+            }
+        }, threads);
+        CHECK(duplicates == 0);
+        return seen;
+    };
+
+    SECTION("In-memory store is visited by the calling thread")
+    {
+        Litestore ls(":memory:");
+        for (int i = 0; i < 100; ++i)
+        {
+            ls.create("key" + std::to_string(i), i);
+        }
+        ls.create("keynull", nullptr);
+        ls.create("other", 0);
+
+        const auto seen = visitAll(ls, 4);
+        REQUIRE(seen.size() == 100);
+        CHECK(seen.at("key42") == 42);
+    }
+
+    SECTION("File is visited by several threads")
+    {
+        const char* filename = "parallel_test.db";
+        std::remove(filename);
+        {
+            Litestore ls(filename);
+            {
+                auto tx = ls.createTx();
+                for (int i = 0; i < 1000; ++i)
+                {
+                    ls.create("key" + std::to_string(i), i);
+                }
+                tx.commit();
+            }
+
+            const auto seen = visitAll(ls, 4);
+            REQUIRE(seen.size() == 1000);
+            for (int i = 0; i < 1000; ++i)
+            {
+                CHECK(seen.at("key" + std::to_string(i)) == i);
+            }
+            CHECK(visitAll(ls, 64).size() == 1000);
+
+            {
+                auto tx = ls.createTx();
+                for (int i = 0; i < 300; ++i)
+                {
+                    ls.create("key\xc3\xa9" + std::to_string(i), i);
+                }
+                tx.commit();
+            }
+            CHECK(visitAll(ls, 4).size() == 1300);
+            CHECK(visitAll(ls, 4, "key\xc3\xa9*").size() == 300);
+            const auto filtered = visitAll(ls, 4, "key?5");
+            CHECK(filtered.size() == 10);
+            CHECK(filtered.at("key95") == 95);
+            CHECK(filtered.at("key\xc3\xa9" "5") == 5);
+
+            CHECK_THROWS_AS(ls.parallelForEach("*", [](KeyView, BlobView)
+                                               {
+                                                   throw std::logic_error("fail");
+                                               }, 4),
+                            std::logic_error);
+        }
+        std::remove(filename);
+    }
+}
@@ -60,4 +60,38 @@ TEST_CASE("Transactions")
         }
         CHECK(ls.read<int>("val") == 50);
     }
+    SECTION("Rollback hooks are called")
+    {
+        int called = 0;
+        {
+            auto tx = ls.createTx();
+            tx.onRollback([&] { ++called; });
+            CHECK(ls.inTx());
+            tx.rollback();
+            CHECK_FALSE(ls.inTx());
+        }
+        {
+            auto tx = ls.createTx();
+            tx.onRollback([&] { ++called; });
+        }
+        {
+            auto tx = ls.createTx();
+            tx.onRollback([&] { ++called; });
+            tx.commit();
+        }
+        CHECK(called == 2);
+    }
+    SECTION("Commit hooks are called")
+    {
+        int committed = 0;
+        int rolledBack = 0;
+        {
+            auto tx = ls.createTx();
+            tx.onCommit([&] { ++committed; });
+            tx.onRollback([&] { ++rolledBack; });
+            tx.commit();
+        }
+        CHECK(committed == 1);
+        CHECK(rolledBack == 0);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "litestorecpp/routed_litestore.hpp"
+
+using namespace lscpp;
+
+TEST_CASE("Routed litestore")
+{
+    const std::string filename = "routed_test.db";
+    std::remove(filename.c_str());
+    {
+        RoutedLitestore ls(filename, 2);
+        ls.create("key", 42);
+
+        SECTION("Reads see committed writes")
+        {
+            CHECK(ls.read<int>("key") == 42);
+            ls.update("key", 43);
+            CHECK(ls.read<int>("key") == 43);
+            CHECK(ls.exists("key"));
+            CHECK(ls.count("*") == 1);
+            CHECK(ls.keys("*") == std::vector<std::string>{"key"});
+
+            ls.del("key");
+            CHECK_FALSE(ls.exists("key"));
+        }
+
+        SECTION("Readers are not blocked by a write transaction")
+        {
+            auto writer = ls.writer();
+            auto tx = writer->createTx();
+            writer->update("key", 43);
+            writer->create("other", 1);
+
+            CHECK(ls.read<int>("key") == 42);
+            CHECK_FALSE(ls.exists("other"));
+
+            tx.commit();
+            CHECK(ls.read<int>("key") == 43);
+            CHECK(ls.exists("other"));
+        }
+
+        SECTION("Concurrent readers and writer")
+        {
+            // Catch assertions are not thread safe
+            std::atomic<int> mismatches(0);
+            std::vector<std::thread> threads;
+            threads.emplace_back([&]
+            {
+                for (int i = 0; i < 100; ++i)
+                {
+                    ls.create("w" + std::to_string(i), i);
+                }
+            });
+            for (int t = 0; t < 4; ++t)
+            {
+                threads.emplace_back([&]
+                {
+                    for (int i = 0; i < 100; ++i)
+                    {
+                        if (ls.read<int>("key") != 42)
+                        {
+                            ++mismatches;
+                        }
+                    }
+                });
+            }
+            for (auto& t : threads)
+            {
+                t.join();
+            }
+            CHECK(mismatches == 0);
+            CHECK(ls.count("w*") == 100);
+        }
+    }
+    std::remove(filename.c_str());
+    std::remove((filename + "-wal").c_str());
+    std::remove((filename + "-shm").c_str());
+}
@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "litestorecpp/sharded_litestore.hpp"
+
+using namespace lscpp;
+
+TEST_CASE("Sharded litestore")
+{
+    ShardedLitestore ls(std::vector<std::string>(4, ":memory:"));
+    REQUIRE(ls.shards() == 4);
+
+    SECTION("Throws without shards")
+    {
+        CHECK_THROWS_AS(ShardedLitestore(std::vector<std::string>()),
+                        std::runtime_error);
+    }
+
+    SECTION("Keys are routed to their shard")
+    {
+        for (int i = 0; i < 100; ++i)
+        {
+            ls.create("key" + std::to_string(i), i);
+        }
+        std::vector<std::size_t> counts(ls.shards());
+        for (std::size_t i = 0; i < ls.shards(); ++i)
+        {
+            counts[i] = ls.shard(i)->count("*");
+            CHECK(counts[i] > 0);
+        }
+        CHECK(ls.count("*") == 100);
+        CHECK(ls.shard(ls.shardOf("key42"))->read<int>("key42") == 42);
+
+        CHECK(ls.read<int>("key7") == 7);
+        ls.update("key7", 8);
+        CHECK(ls.read<int>("key7") == 8);
+        ls.del("key7");
+        CHECK_FALSE(ls.exists("key7"));
+    }
+
+    SECTION("Keys are merged in order")
+    {
+        std::vector<std::string> expected;
+        for (int i = 0; i < 50; ++i)
+        {
+            expected.push_back("key" + std::to_string(i));
+            ls.create(expected.back(), i);
+        }
+        ls.create("other", 0);
+        std::sort(expected.begin(), expected.end());
+
+        CHECK(ls.keys("key*") == expected);
+    }
+
+    SECTION("Per shard transactions")
+    {
+        const auto i = ls.shardOf("key");
+        {
+            auto shard = ls.shard(i);
+            auto tx = shard->createTx();
+            shard->create("key", 1);
+        }
+        CHECK_FALSE(ls.exists("key"));
+    }
+
+    SECTION("Shards are visited concurrently")
+    {
+        ls.forEachShard([](std::size_t i, Litestore& store)
+        {
+            auto tx = store.createTx();
+            store.create("shard", static_cast<int>(i));
+            tx.commit();
+        });
+        for (std::size_t i = 0; i < ls.shards(); ++i)
+        {
+            CHECK(ls.shard(i)->read<int>("shard") == static_cast<int>(i));
+        }
+
+        CHECK_THROWS_AS(ls.forEachShard([](std::size_t, Litestore&)
+                                        {
+                                            throw std::logic_error("fail");
+                                        }),
+                        std::logic_error);
+    }
+
+    SECTION("Concurrent writers")
+    {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&ls, t]
+            {
+                for (int i = 0; i < 50; ++i)
+                {
+                    ls.create(std::to_string(t) + "_" + std::to_string(i), i);
+                }
+            });
+        }
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+        CHECK(ls.count("*") == 200);
+    }
+}
+
+TEST_CASE("Sharded litestore files")
+{
+    const std::string basename = "sharded_test.db";
+    const auto remove = [&]
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            std::remove((basename + "." + std::to_string(i)).c_str());
+        }
+    };
+    remove();
+    {
+        ShardedLitestore ls(basename, 3);
+        for (int i = 0; i < 30; ++i)
+        {
+            ls.create("key" + std::to_string(i), i);
+        }
+    }
+    {
+        ShardedLitestore ls(basename, 3);
+        for (int i = 0; i < 30; ++i)
+        {
+            CHECK(ls.read<int>("key" + std::to_string(i)) == i);
+        }
+    }
+    remove();
+}
@@ -0,0 +1,97 @@
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+#include "catch.hpp"
+
+#include "litestorecpp/write_buffer.hpp"
+
+using namespace lscpp;
+
+TEST_CASE("Write buffer")
+{
+    Litestore ls(":memory:");
+    ls.create("key", 1);
+
+    SECTION("Throws if transaction not open")
+    {
+        auto tx = ls.createTx();
+        tx.commit();
+
+        CHECK_THROWS_AS(WriteBuffer(ls, tx), std::runtime_error);
+    }
+
+    SECTION("Last write per key is flushed on commit")
+    {
+        {
+            auto tx = ls.createTx();
+            WriteBuffer wb(ls, tx);
+            for (int i = 2; i <= 10; ++i)
+            {
+                wb.update("key", i);
+            }
+            wb.update("str", std::string("abc"));
+            wb.update("null", nullptr);
+            CHECK(wb.size() == 3);
+            // nothing written yet
+            CHECK(ls.read<int>("key") == 1);
+
+            tx.commit();
+            CHECK(wb.size() == 0);
+        }
+        CHECK(ls.read<int>("key") == 10);
+        CHECK(ls.read<std::string>("str") == "abc");
+        CHECK(ls.read<std::nullptr_t>("null") == nullptr);
+    }
+
+    SECTION("Reads are served from the buffer")
+    {
+        auto tx = ls.createTx();
+        WriteBuffer wb(ls, tx);
+
+        CHECK(wb.read<int>("key") == 1);
+        wb.update("key", 2);
+        CHECK(wb.read<int>("key") == 2);
+        wb.update("null", nullptr);
+        CHECK(wb.read<std::nullptr_t>("null") == nullptr);
+        CHECK_THROWS_AS(wb.read<int>("null"), std::runtime_error);
+        wb.del("key");
+        CHECK_THROWS_AS(wb.read<int>("key"), std::runtime_error);
+    }
+
+    SECTION("Deletes are flushed")
+    {
+        {
+            auto tx = ls.createTx();
+            WriteBuffer wb(ls, tx);
+            wb.update("key", 2);
+            wb.del("key");
+            tx.commit();
+        }
+        CHECK_FALSE(ls.exists("key"));
+    }
+
+    SECTION("Rollback discards the buffer")
+    {
+        {
+            auto tx = ls.createTx();
+            WriteBuffer wb(ls, tx);
+            wb.update("key", 2);
+            tx.rollback();
+            CHECK(wb.size() == 0);
+        }
+        CHECK(ls.read<int>("key") == 1);
+    }
+
+    SECTION("Buffer may be destroyed before commit")
+    {
+        auto tx = ls.createTx();
+        {
+            WriteBuffer wb(ls, tx);
+            wb.update("key", 2);
+        }
+        tx.commit();
+
+        CHECK(ls.read<int>("key") == 2);
+    }
+}